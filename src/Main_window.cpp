@@ -2,6 +2,7 @@
 // Qt
 //#include <QFileDialog>
 //#include <qsettings.h>
+#include <QStatusBar>
 // local
 #include "ui_Main_window.h"
 #include "ui_Isotropic_parameters.h"
@@ -31,6 +32,15 @@ MainWindow::MainWindow(QWidget *parent)
   connect(ui->actionFile_quit, SIGNAL(triggered()), this, SLOT(quit()));
   this->addRecentFiles(ui->menuFile, ui->actionFile_quit);
   connect(this, SIGNAL(openRecentFile(QString)), this, SLOT(open(QString)));
+  // the background remeshing publishes previews and reports its end
+  connect(m_pScene, SIGNAL(preview_updated()), m_pViewer, SLOT(update()));
+  connect(m_pScene, SIGNAL(remeshing_finished()),
+          this, SLOT(remeshing_finished()));
+  // files are loaded in the background as well
+  connect(m_pScene, SIGNAL(loading_progress(QString)),
+          this, SLOT(loading_progress(QString)));
+  connect(m_pScene, SIGNAL(file_opened(QString, bool)),
+          this, SLOT(file_opened(QString, bool)));
 
   readSettings();
   update_menu_items();
@@ -87,6 +97,7 @@ void MainWindow::dropEvent(QDropEvent *event) {
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
+  m_pScene->cancel_remeshing();
   writeSettings();
   event->accept();
 }
@@ -248,27 +259,21 @@ void MainWindow::on_actionMinAngle_remesh_reset_from_input_triggered() {
 }
 
 void MainWindow::on_actionMinAngle_remesh_generate_links_triggered() {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // runs in the background, see remeshing_finished()
   m_pScene->generate_links();
-  QApplication::restoreOverrideCursor();
-  m_pViewer->update();
-  update_menu_items();
+  set_remeshing_running(m_pScene->is_worker_busy());
 }
 
 void MainWindow::on_actionMinAngle_remeshing_triggered() {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // runs in the background, see remeshing_finished()
   m_pScene->minangle_remeshing();
-  QApplication::restoreOverrideCursor();
-  m_pViewer->update();
-  update_menu_items();
+  set_remeshing_running(m_pScene->is_worker_busy());
 }
 
 void MainWindow::on_actionMinAngle_initial_mesh_simplification_triggered() {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // runs in the background, see remeshing_finished()
   m_pScene->initial_mesh_simplification();
-  QApplication::restoreOverrideCursor();
-  m_pViewer->update();
-  update_menu_items();
+  set_remeshing_running(m_pScene->is_worker_busy());
 }
 
 void MainWindow::on_actionMinAngle_split_local_longest_edge_triggered() {
@@ -288,17 +293,23 @@ void MainWindow::on_actionMinAngle_increase_minimal_angle_triggered() {
 }
 
 void MainWindow::on_actionMinAngle_maximize_minimal_angle_triggered() {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // runs in the background, see remeshing_finished()
   m_pScene->maximize_minimal_angle();
-  QApplication::restoreOverrideCursor();
-  m_pViewer->update();
-  update_menu_items();
+  set_remeshing_running(m_pScene->is_worker_busy());
 }
 
 void MainWindow::on_actionMinAngle_final_Vertex_relocation_triggered() {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // runs in the background, see remeshing_finished()
   m_pScene->final_vertex_relocation();
-  QApplication::restoreOverrideCursor();
+  set_remeshing_running(m_pScene->is_worker_busy());
+}
+
+void MainWindow::on_actionMinAngle_cancel_remeshing_triggered() {
+  m_pScene->cancel_remeshing();
+}
+
+void MainWindow::remeshing_finished() {
+  set_remeshing_running(false);
   m_pViewer->update();
   update_menu_items();
 }
@@ -340,8 +351,7 @@ void MainWindow::on_actionMinAngle_parameter_settings_triggered() {
   current_index = sns == SampleNumberStrategy::k_fixed ? 0 : 1;
   ps.set_sample_number_strategy(current_index);
   SampleStrategy ss = m_pScene->get_sample_strategy();
-  current_index = ss == SampleStrategy::k_uniform ? 0 : 1;
-  ps.set_sample_strategy(current_index);
+  ps.set_sample_strategy(static_cast<int>(ss));    // same order
   ps.set_use_stratified_sampling(m_pScene->get_use_stratified_sampling());
   // feature function parameters
   ps.set_sum_theta(m_pScene->get_sum_theta());
@@ -400,8 +410,7 @@ void MainWindow::on_actionMinAngle_parameter_settings_triggered() {
     // sample parameters
     sns = ps.get_sample_number_strategy() == 0 ?
       SampleNumberStrategy::k_fixed : SampleNumberStrategy::k_variable;
-    ss = ps.get_sample_strategy() == 0 ?
-      SampleStrategy::k_uniform : SampleStrategy::k_adaptive;
+    ss = static_cast<SampleStrategy>(ps.get_sample_strategy());
     bool samples_changed =
       (m_pScene->get_samples_per_face_in() != ps.get_samples_per_face_in()) ||
       (m_pScene->get_samples_per_face_out() != ps.get_samples_per_face_out()) ||
@@ -685,33 +694,65 @@ void MainWindow::on_actionView_vertex_out_links_triggered() {
 
 void MainWindow::open(QString file_name, OpenType open_type) {
   QFileInfo file_info(file_name);
+  if (m_pScene->is_worker_busy()) {   // e.g. dropped while remeshing
+    return;
+  }
   if (file_info.isFile() && file_info.isReadable()) {
-    QApplication::setOverrideCursor(QCursor(::Qt::WaitCursor));
-    bool suc = false;
+    // loads in the background, see file_opened()
     switch (open_type) {
     case OpenType::k_open_both:
-      suc = m_pScene->open(file_name);
+      m_pScene->open(file_name);
       break;
     case OpenType::k_open_input:
-      suc = m_pScene->open_input(file_name);
+      m_pScene->open_input(file_name);
       break;
     case OpenType::k_open_remesh:
-      suc = m_pScene->open_remesh(file_name);
+      m_pScene->open_remesh(file_name);
       break;
     default:
       break;
     }
-    if (suc) {
-      QSettings settings;
-      settings.setValue("Open directory",
-        file_info.absoluteDir().absolutePath());
-      this->addToRecentFiles(file_name);
-      updateViewerBBox();
-      m_pViewer->update();
-      update_menu_items();
-    }
-    QApplication::restoreOverrideCursor();
+    set_remeshing_running(m_pScene->is_worker_busy());
+  }
+}
+
+void MainWindow::loading_progress(QString message) {
+  statusBar()->showMessage(message);
+}
+
+void MainWindow::file_opened(QString file_name, bool succeeded) {
+  // remeshing_finished() follows and enables the menus again
+  QFileInfo file_info(file_name);
+  if (succeeded) {
+    QSettings settings;
+    settings.setValue("Open directory",
+      file_info.absoluteDir().absolutePath());
+    this->addToRecentFiles(file_name);
+    updateViewerBBox();
+    statusBar()->showMessage(
+      QString("Opened \"%1\"").arg(file_info.fileName()), 5000);
+  }
+  else {
+    statusBar()->showMessage(
+      QString("Unable to open \"%1\"").arg(file_info.fileName()), 5000);
+  }
+}
+
+void MainWindow::set_remeshing_running(bool running) {
+  // everything that touches the meshes waits for the background remeshing,
+  // except the cancel action
+  ui->actionFile_open->setEnabled(!running);
+  ui->actionFile_open_input->setEnabled(!running);
+  ui->actionFile_open_remesh->setEnabled(!running);
+  ui->actionFile_save_remesh_as->setEnabled(!running);
+  ui->menuInput->setEnabled(!running);
+  ui->menuRemesh->setEnabled(!running);
+  ui->menuView->setEnabled(!running);
+  QList<QAction*> actions = ui->menuMinAngle->actions();
+  for (int i = 0; i < actions.size(); ++i) {
+    actions[i]->setEnabled(!running);
   }
+  ui->actionMinAngle_cancel_remeshing->setEnabled(running);
 }
 
 void MainWindow::update_menu_items() {
@@ -78,6 +78,10 @@ class MainWindow : public CGAL::Qt::DemosMainWindow {
   void on_actionMinAngle_increase_minimal_angle_triggered();
   void on_actionMinAngle_maximize_minimal_angle_triggered();
   void on_actionMinAngle_final_Vertex_relocation_triggered();
+  void on_actionMinAngle_cancel_remeshing_triggered();
+  void remeshing_finished();
+  void loading_progress(QString message);
+  void file_opened(QString file_name, bool succeeded);
   void on_actionMinAngle_parameter_settings_triggered();
   void on_actionMinAngle_remesh_properties_triggered();
   
@@ -128,6 +132,7 @@ class MainWindow : public CGAL::Qt::DemosMainWindow {
 private:
   void open(QString file_name, OpenType open_type);
   void update_menu_items();
+  void set_remeshing_running(bool running);
 
 private:
   // objects
@@ -18,6 +18,7 @@ class MinAngleParameters : public QDialog, private Ui_MinAngleParametersDialog {
     QStringList sample_strategy_types;
     sample_strategy_types.append("Uniform");
     sample_strategy_types.append("Adaptive");
+    sample_strategy_types.append("Error driven");
     cb_sample_strategy->addItems(sample_strategy_types);
     cb_sample_strategy->setCurrentIndex(1);
     // fill the items in cb_face_relocate_type, 
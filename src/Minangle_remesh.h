@@ -35,6 +35,7 @@ class Minangle_remesh {
   typedef typename internal::Minangle_remesher<Kernel> Minangle_remesher;
   typedef typename Minangle_remesher::FT FT;
   typedef typename Minangle_remesher::Mesh Mesh;
+  typedef typename Minangle_remesher::Memory_report Memory_report;
 
   // life cycle
   Minangle_remesh() {
@@ -80,7 +81,12 @@ class Minangle_remesh {
       OptimizeType face_optimize_type,
       OptimizeType edge_optimize_type,
       OptimizeType vertex_optimize_type,
-      bool optimize_after_local_operations) {
+      bool optimize_after_local_operations,
+      bool use_face_geometry_cache = true,
+      int collapse_batch_size = 1,
+      bool reorder_elements = false,
+      FT max_garbage_ratio = 0.25,
+      int sampling_thread_count = 0) {
     NamedParameters np;
     // general parameters
     np.max_error_threshold = max_error_threshold;
@@ -99,12 +105,17 @@ class Minangle_remesh {
     np.verbose_progress = verbose_progress;
     np.apply_initial_mesh_simplification = apply_initial_mesh_simplification;
     np.apply_final_vertex_relocation = apply_final_vertex_relocation;
+    np.use_face_geometry_cache = use_face_geometry_cache;
+    np.collapse_batch_size = collapse_batch_size;
+    np.reorder_elements = reorder_elements;
+    np.max_garbage_ratio = max_garbage_ratio;
     // sample parameters
     np.samples_per_face_in = samples_per_face_in;
     np.samples_per_face_out = samples_per_face_out;
     np.max_samples_per_area = max_samples_per_area;
     np.min_samples_per_triangle = min_samples_per_triangle;
     np.bvd_iteration_count = bvd_iteration_count;
+    np.sampling_thread_count = sampling_thread_count;
     np.sample_number_strategy = sample_number_strategy;
     np.sample_strategy = sample_strategy;
     np.use_stratified_sampling = use_stratified_sampling;
@@ -162,6 +173,10 @@ class Minangle_remesh {
     remesher_->generate_samples_and_links();
   }
 
+  void calculate_memory_usage(Memory_report *report) const {
+    remesher_->calculate_memory_usage(report);
+  }
+
   void minangle_remeshing() const {
     remesher_->minangle_remeshing();
   }
@@ -6,8 +6,14 @@
 //#include <QDebug>
 //#include <CGAL/Polygon_mesh_processing/border.h>
 //#include <CGAL/IO/PLY_reader.h>
+#include <algorithm>
 #include <CGAL/Polygon_mesh_processing/remesh.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
+#ifdef CGAL_LINKED_WITH_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
 
 Scene::Scene() 
   : m_frame(new ManipulatedFrame()), 
@@ -47,9 +53,42 @@ Scene::Scene()
   // 3) parameters initialization
   m_target_edge_length = TARGET_EDGE_LENGTH;
   m_smooth_iteration_count = SMOOTH_ITERATION_COUNT;
+  // 4) buffers are allocated on their first upload
+  for (int i = 0; i < VBOs::kb_NbOfVbos; ++i) {
+    m_buffer_capacities[i] = 0;
+    m_is_buffer_modified[i] = true;
+  }
+  // 5) background remeshing (the worker is started on the first command)
+  m_worker_stop = false;
+  m_worker_busy = false;
+  m_cancel_requested = false;
+  m_operation_finished = false;
+  m_preview_ready = false;
+  m_preview_operation_count = PREVIEW_OPERATION_COUNT;
+  m_preview_interval = PREVIEW_INTERVAL;
+  m_nb_unpublished_operations = 0;
+  m_loading_stage = k_not_loading;
+  m_reported_loading_stage = k_not_loading;
+  m_loading_memory_estimate = 0;
+  m_loading_succeeded = false;
+  m_minangle_remesh.get_remesher()->set_progress_callback(
+      [this]() { return report_progress(); });
+  // 6) level of detail (the budget is updated in each draw)
+  m_lod_pixels_per_element = LOD_PIXELS_PER_ELEMENT;
+  m_lod_budget = 0;
 }
 
 Scene::~Scene() {
+  // stop the background remeshing first
+  m_cancel_requested = true;
+  {
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    m_worker_stop = true;
+  }
+  m_worker_condition.notify_one();
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
   // member data
   delete m_frame;
   if (gl != NULL) {
@@ -176,11 +215,14 @@ void Scene::compile_shaders() {
     "uniform highp float spec_power;\n"
     "uniform int is_two_side;\n"
     "uniform bool is_selected;\n"
+    "uniform bool is_flat;\n"
     "void main(void) {\n"
     "  highp vec3 L = light_pos.xyz - fP.xyz;\n"
     "  highp vec3 V = -fP.xyz;\n"
     "  highp vec3 N;\n"
-    "  if (fN == highp vec3(0.0, 0.0, 0.0))\n"
+    "  if (is_flat)\n"        // face normal of the indexed faces
+    "    N = normalize(cross(dFdx(fP.xyz), dFdy(fP.xyz)));\n"
+    "  else if (fN == highp vec3(0.0, 0.0, 0.0))\n"
     "    N = highp vec3(0.0, 0.0, 0.0);\n"
     "  else\n"
     "    N = normalize(fN);\n"
@@ -227,8 +269,7 @@ void Scene::initialize_buffers() {
   vao[VAOs::ka_Input_faces].bind();
   // bind the pos_face
   vbo[VBOs::kb_Input_face_pos].bind();
-  vbo[VBOs::kb_Input_face_pos].allocate(pos_input_faces.data(),
-      static_cast<int>(pos_input_faces.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_face_pos, pos_input_faces);
   rendering_program_with_light.bind();
   poly_vertexLocation_with_light =
       rendering_program_with_light.attributeLocation("vertex");
@@ -240,8 +281,7 @@ void Scene::initialize_buffers() {
   vbo[VBOs::kb_Input_face_pos].release();
   // bind the pos_face_normal
   vbo[VBOs::kb_Input_face_normals].bind();
-  vbo[VBOs::kb_Input_face_normals].allocate(pos_input_face_normals.data(),
-      static_cast<int>(pos_input_face_normals.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_face_normals, pos_input_face_normals);
   rendering_program_with_light.bind();
   normalLocation_with_light =
       rendering_program_with_light.attributeLocation("normals");
@@ -253,8 +293,7 @@ void Scene::initialize_buffers() {
   vbo[VBOs::kb_Input_face_normals].release();
   // bind the pos_face_colors
   vbo[VBOs::kb_Input_face_colors].bind();
-  vbo[VBOs::kb_Input_face_colors].allocate(pos_input_face_colors.data(),
-    static_cast<int>(pos_input_face_colors.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_face_colors, pos_input_face_colors);
   rendering_program_with_light.bind();
   colorLocation_with_light =
       rendering_program_with_light.attributeLocation("colors");
@@ -269,8 +308,7 @@ void Scene::initialize_buffers() {
   vao[VAOs::ka_Remesh_faces].bind();
   // bind the pos_face
   vbo[VBOs::kb_Remesh_face_pos].bind();
-  vbo[VBOs::kb_Remesh_face_pos].allocate(pos_remesh_faces.data(),
-      static_cast<int>(pos_remesh_faces.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_face_pos, pos_remesh_faces);
   rendering_program_with_light.bind();
   poly_vertexLocation_with_light =
       rendering_program_with_light.attributeLocation("vertex");
@@ -282,8 +320,7 @@ void Scene::initialize_buffers() {
   vbo[VBOs::kb_Remesh_face_pos].release();
   // bind the pos_face_normal
   vbo[VBOs::kb_Remesh_face_normals].bind();
-  vbo[VBOs::kb_Remesh_face_normals].allocate(pos_remesh_face_normals.data(),
-      static_cast<int>(pos_remesh_face_normals.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_face_normals, pos_remesh_face_normals);
   rendering_program_with_light.bind();
   normalLocation_with_light =
       rendering_program_with_light.attributeLocation("normals");
@@ -294,8 +331,7 @@ void Scene::initialize_buffers() {
   vbo[VBOs::kb_Remesh_face_normals].release();
   // bind the pos_ifi_colors
   vbo[VBOs::kb_Remesh_face_colors].bind();
-  vbo[VBOs::kb_Remesh_face_colors].allocate(pos_remesh_face_colors.data(),
-      static_cast<int>(pos_remesh_face_colors.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_face_colors, pos_remesh_face_colors);
   rendering_program_with_light.bind();
   colorLocation_with_light =
       rendering_program_with_light.attributeLocation("colors");
@@ -309,8 +345,7 @@ void Scene::initialize_buffers() {
   // Input cell boundaries
   vao[VAOs::ka_Input_boundaries].bind();
   vbo[VBOs::kb_Input_boundary_pos].bind();
-  vbo[VBOs::kb_Input_boundary_pos].allocate(pos_input_boundaries.data(),
-      static_cast<int>(pos_input_boundaries.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_boundary_pos, pos_input_boundaries);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -322,8 +357,7 @@ void Scene::initialize_buffers() {
   // Remesh cell boundaries
   vao[VAOs::ka_Remesh_boundaries].bind();
   vbo[VBOs::kb_Remesh_boundary_pos].bind();
-  vbo[VBOs::kb_Remesh_boundary_pos].allocate(pos_remesh_boundaries.data(),
-      static_cast<int>(pos_remesh_boundaries.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_boundary_pos, pos_remesh_boundaries);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -335,8 +369,7 @@ void Scene::initialize_buffers() {
   // Input samples
   vao[VAOs::ka_Input_samples].bind();
   vbo[VBOs::kb_Input_sample_pos].bind();
-  vbo[VBOs::kb_Input_sample_pos].allocate(pos_input_samples.data(),
-      static_cast<int>(pos_input_samples.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_sample_pos, pos_input_samples);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -348,8 +381,7 @@ void Scene::initialize_buffers() {
   // Remesh samples
   vao[VAOs::ka_Remesh_samples].bind();
   vbo[VBOs::kb_Remesh_sample_pos].bind();
-  vbo[VBOs::kb_Remesh_sample_pos].allocate(pos_remesh_samples.data(),
-      static_cast<int>(pos_remesh_samples.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_sample_pos, pos_remesh_samples);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -361,8 +393,7 @@ void Scene::initialize_buffers() {
   // Input normal edges
   vao[VAOs::ka_Input_normal_edges].bind();
   vbo[VBOs::kb_Input_normal_edge_pos].bind();
-  vbo[VBOs::kb_Input_normal_edge_pos].allocate(pos_input_normal_edges.data(),
-      static_cast<int>(pos_input_normal_edges.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_normal_edge_pos, pos_input_normal_edges);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -374,8 +405,7 @@ void Scene::initialize_buffers() {
   // Remesh normal edges
   vao[VAOs::ka_Remesh_normal_edges].bind();
   vbo[VBOs::kb_Remesh_normal_edge_pos].bind();
-  vbo[VBOs::kb_Remesh_normal_edge_pos].allocate(pos_remesh_normal_edges.data(),
-      static_cast<int>(pos_remesh_normal_edges.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_normal_edge_pos, pos_remesh_normal_edges);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -387,8 +417,7 @@ void Scene::initialize_buffers() {
   // Input min radian edges
   vao[VAOs::ka_Input_special_edges].bind();
   vbo[VBOs::kb_Input_special_edge_pos].bind();
-  vbo[VBOs::kb_Input_special_edge_pos].allocate(pos_input_special_edges.data(),
-      static_cast<int>(pos_input_special_edges.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Input_special_edge_pos, pos_input_special_edges);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -400,9 +429,7 @@ void Scene::initialize_buffers() {
   // Remesh min radian edges
   vao[VAOs::ka_Remesh_special_edges].bind();
   vbo[VBOs::kb_Remesh_special_edge_pos].bind();
-  vbo[VBOs::kb_Remesh_special_edge_pos].allocate(
-      pos_remesh_special_edges.data(),
-      static_cast<int>(pos_remesh_special_edges.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Remesh_special_edge_pos, pos_remesh_special_edges);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -411,12 +438,63 @@ void Scene::initialize_buffers() {
   vbo[VBOs::kb_Remesh_special_edge_pos].release();
   vao[VAOs::ka_Remesh_special_edges].release();
 
+  // Input and remesh indexed faces and mesh edges, which share the vertices.
+  // The index buffers are bound to GL_ELEMENT_ARRAY_BUFFER when drawn
+  const int indexed_vaos[2][2] = {
+    { VAOs::ka_Input_indexed_faces, VAOs::ka_Input_indexed_edges },
+    { VAOs::ka_Remesh_indexed_faces, VAOs::ka_Remesh_indexed_edges } };
+  const int indexed_vbos[2][3] = {
+    { VBOs::kb_Input_vertex_pos, VBOs::kb_Input_face_indices,
+      VBOs::kb_Input_edge_indices },
+    { VBOs::kb_Remesh_vertex_pos, VBOs::kb_Remesh_face_indices,
+      VBOs::kb_Remesh_edge_indices } };
+  const std::vector<float> *indexed_vertices[2] = {
+    &pos_input_vertices, &pos_remesh_vertices };
+  const std::vector<GLuint> *indexed_faces[2] = {
+    &idx_input_faces, &idx_remesh_faces };
+  const std::vector<GLuint> *indexed_edges[2] = {
+    &idx_input_edges, &idx_remesh_edges };
+  for (int i = 0; i < 2; ++i) {
+    vbo[indexed_vbos[i][0]].bind();
+    upload_buffer(indexed_vbos[i][0], *indexed_vertices[i]);
+    vbo[indexed_vbos[i][0]].release();
+    vbo[indexed_vbos[i][1]].bind();
+    upload_buffer(indexed_vbos[i][1], *indexed_faces[i]);
+    vbo[indexed_vbos[i][1]].release();
+    vbo[indexed_vbos[i][2]].bind();
+    upload_buffer(indexed_vbos[i][2], *indexed_edges[i]);
+    vbo[indexed_vbos[i][2]].release();
+    // faces: no normal nor color arrays, see draw_indexed_faces()
+    vao[indexed_vaos[i][0]].bind();
+    vbo[indexed_vbos[i][0]].bind();
+    rendering_program_with_light.bind();
+    rendering_program_with_light.enableAttributeArray(
+        poly_vertexLocation_with_light);
+    rendering_program_with_light.setAttributeBuffer(
+        poly_vertexLocation_with_light, GL_FLOAT, 0, 3);
+    rendering_program_with_light.disableAttributeArray(
+        normalLocation_with_light);
+    rendering_program_with_light.disableAttributeArray(
+        colorLocation_with_light);
+    rendering_program_with_light.release();
+    vbo[indexed_vbos[i][0]].release();
+    vao[indexed_vaos[i][0]].release();
+    // edges
+    vao[indexed_vaos[i][1]].bind();
+    vbo[indexed_vbos[i][0]].bind();
+    lines_vertexLocation = rendering_program.attributeLocation("vertex");
+    rendering_program.bind();
+    rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
+    rendering_program.enableAttributeArray(lines_vertexLocation);
+    rendering_program.release();
+    vbo[indexed_vbos[i][0]].release();
+    vao[indexed_vaos[i][1]].release();
+  }
+
   // Face in start points
   vao[VAOs::ka_Face_in_start].bind();
   vbo[VBOs::kb_Face_in_start_points].bind();
-  vbo[VBOs::kb_Face_in_start_points].allocate(
-      pos_face_in_start_points.data(),
-      static_cast<int>(pos_face_in_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_in_start_points, pos_face_in_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -428,8 +506,7 @@ void Scene::initialize_buffers() {
   // Face in end points
   vao[VAOs::ka_Face_in_end].bind();
   vbo[VBOs::kb_Face_in_end_points].bind();
-  vbo[VBOs::kb_Face_in_end_points].allocate(pos_face_in_end_points.data(),
-      static_cast<int>(pos_face_in_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_in_end_points, pos_face_in_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -441,8 +518,7 @@ void Scene::initialize_buffers() {
   // Face in links
   vao[VAOs::ka_Face_in_links].bind();
   vbo[VBOs::kb_Face_in_link_lines].bind();
-  vbo[VBOs::kb_Face_in_link_lines].allocate(pos_face_in_links.data(),
-      static_cast<int>(pos_face_in_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_in_link_lines, pos_face_in_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -454,9 +530,7 @@ void Scene::initialize_buffers() {
   // Face out start points
   vao[VAOs::ka_Face_out_start].bind();
   vbo[VBOs::kb_Face_out_start_points].bind();
-  vbo[VBOs::kb_Face_out_start_points].allocate(
-      pos_face_out_start_points.data(),
-      static_cast<int>(pos_face_out_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_out_start_points, pos_face_out_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -468,8 +542,7 @@ void Scene::initialize_buffers() {
   // Face out end points
   vao[VAOs::ka_Face_out_end].bind();
   vbo[VBOs::kb_Face_out_end_points].bind();
-  vbo[VBOs::kb_Face_out_end_points].allocate(pos_face_out_end_points.data(),
-      static_cast<int>(pos_face_out_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_out_end_points, pos_face_out_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -481,8 +554,7 @@ void Scene::initialize_buffers() {
   // Face out links
   vao[VAOs::ka_Face_out_links].bind();
   vbo[VBOs::kb_Face_out_link_lines].bind();
-  vbo[VBOs::kb_Face_out_link_lines].allocate(pos_face_out_links.data(),
-      static_cast<int>(pos_face_out_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Face_out_link_lines, pos_face_out_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -494,8 +566,7 @@ void Scene::initialize_buffers() {
   // Edge in start points
   vao[VAOs::ka_Edge_in_start].bind();
   vbo[VBOs::kb_Edge_in_start_points].bind();
-  vbo[VBOs::kb_Edge_in_start_points].allocate(pos_edge_in_start_points.data(),
-      static_cast<int>(pos_edge_in_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_in_start_points, pos_edge_in_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -507,8 +578,7 @@ void Scene::initialize_buffers() {
   // Edge in end points
   vao[VAOs::ka_Edge_in_end].bind();
   vbo[VBOs::kb_Edge_in_end_points].bind();
-  vbo[VBOs::kb_Edge_in_end_points].allocate(pos_edge_in_end_points.data(),
-      static_cast<int>(pos_edge_in_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_in_end_points, pos_edge_in_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -520,8 +590,7 @@ void Scene::initialize_buffers() {
   // Edge in links
   vao[VAOs::ka_Edge_in_links].bind();
   vbo[VBOs::kb_Edge_in_link_lines].bind();
-  vbo[VBOs::kb_Edge_in_link_lines].allocate(pos_edge_in_links.data(),
-      static_cast<int>(pos_edge_in_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_in_link_lines, pos_edge_in_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -533,9 +602,7 @@ void Scene::initialize_buffers() {
   // Edge out start points
   vao[VAOs::ka_Edge_out_start].bind();
   vbo[VBOs::kb_Edge_out_start_points].bind();
-  vbo[VBOs::kb_Edge_out_start_points].allocate(
-      pos_edge_out_start_points.data(),
-      static_cast<int>(pos_edge_out_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_out_start_points, pos_edge_out_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -547,8 +614,7 @@ void Scene::initialize_buffers() {
   // Edge out end points
   vao[VAOs::ka_Edge_out_end].bind();
   vbo[VBOs::kb_Edge_out_end_points].bind();
-  vbo[VBOs::kb_Edge_out_end_points].allocate(pos_edge_out_end_points.data(),
-      static_cast<int>(pos_edge_out_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_out_end_points, pos_edge_out_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -560,8 +626,7 @@ void Scene::initialize_buffers() {
   // Edge out links
   vao[VAOs::ka_Edge_out_links].bind();
   vbo[VBOs::kb_Edge_out_link_lines].bind();
-  vbo[VBOs::kb_Edge_out_link_lines].allocate(pos_edge_out_links.data(),
-      static_cast<int>(pos_edge_out_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Edge_out_link_lines, pos_edge_out_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -573,9 +638,8 @@ void Scene::initialize_buffers() {
   // Vertex in start points
   vao[VAOs::ka_Vertex_in_start].bind();
   vbo[VBOs::kb_Vertex_in_start_points].bind();
-  vbo[VBOs::kb_Vertex_in_start_points].allocate(
-      pos_vertex_in_start_points.data(),
-      static_cast<int>(pos_vertex_in_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_in_start_points,
+      pos_vertex_in_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -587,8 +651,7 @@ void Scene::initialize_buffers() {
   // Vertex in end points
   vao[VAOs::ka_Vertex_in_end].bind();
   vbo[VBOs::kb_Vertex_in_end_points].bind();
-  vbo[VBOs::kb_Vertex_in_end_points].allocate(pos_vertex_in_end_points.data(),
-      static_cast<int>(pos_vertex_in_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_in_end_points, pos_vertex_in_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -600,8 +663,7 @@ void Scene::initialize_buffers() {
   // Vertex in links
   vao[VAOs::ka_Vertex_in_links].bind();
   vbo[VBOs::kb_Vertex_in_link_lines].bind();
-  vbo[VBOs::kb_Vertex_in_link_lines].allocate(pos_vertex_in_links.data(),
-      static_cast<int>(pos_vertex_in_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_in_link_lines, pos_vertex_in_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -613,9 +675,8 @@ void Scene::initialize_buffers() {
   // Vertex out start points
   vao[VAOs::ka_Vertex_out_start].bind();
   vbo[VBOs::kb_Vertex_out_start_points].bind();
-  vbo[VBOs::kb_Vertex_out_start_points].allocate(
-      pos_vertex_out_start_points.data(),
-      static_cast<int>(pos_vertex_out_start_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_out_start_points,
+      pos_vertex_out_start_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -627,9 +688,7 @@ void Scene::initialize_buffers() {
   // Vertex out end points
   vao[VAOs::ka_Vertex_out_end].bind();
   vbo[VBOs::kb_Vertex_out_end_points].bind();
-  vbo[VBOs::kb_Vertex_out_end_points].allocate( 
-      pos_vertex_out_end_points.data(),
-      static_cast<int>(pos_vertex_out_end_points.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_out_end_points, pos_vertex_out_end_points);
   points_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(points_vertexLocation, GL_FLOAT, 0, 3);
@@ -641,8 +700,7 @@ void Scene::initialize_buffers() {
   // Vertex out links
   vao[VAOs::ka_Vertex_out_links].bind();
   vbo[VBOs::kb_Vertex_out_link_lines].bind();
-  vbo[VBOs::kb_Vertex_out_link_lines].allocate(pos_vertex_out_links.data(),
-      static_cast<int>(pos_vertex_out_links.size() * sizeof(float)));
+  upload_buffer(VBOs::kb_Vertex_out_link_lines, pos_vertex_out_links);
   lines_vertexLocation = rendering_program.attributeLocation("vertex");
   rendering_program.bind();
   rendering_program.setAttributeBuffer(lines_vertexLocation, GL_FLOAT, 0, 3);
@@ -654,6 +712,56 @@ void Scene::initialize_buffers() {
   are_buffers_initialized = true;
 }
 
+void Scene::upload_buffer(int index, const void *data, std::size_t size) {
+  // the vbo has to be bound. The buffer is over-allocated, so that the ranges
+  // recorded by add_buffer_ranges() can be written in place
+  const char *bytes = static_cast<const char*>(data);
+  if (static_cast<int>(size) > m_buffer_capacities[index]) {
+    m_buffer_capacities[index] = static_cast<int>(size + size / 2);
+    vbo[index].allocate(m_buffer_capacities[index]);
+    m_is_buffer_modified[index] = true;
+  }
+  if (m_is_buffer_modified[index]) {
+    if (size > 0) {
+      vbo[index].write(0, bytes, static_cast<int>(size));
+    }
+  }
+  else {
+    const std::vector<std::pair<std::size_t, std::size_t>> &ranges =
+      m_buffer_ranges[index];
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+      std::size_t end = std::min(ranges[i].second, size);
+      if (ranges[i].first < end) {
+        vbo[index].write(static_cast<int>(ranges[i].first),
+          bytes + ranges[i].first, static_cast<int>(end - ranges[i].first));
+      }
+    }
+  }
+  m_is_buffer_modified[index] = false;
+  m_buffer_ranges[index].clear();
+}
+
+void Scene::add_buffer_ranges(int index,
+    const std::vector<std::size_t> &slots, std::size_t slot_size) {
+  // merge the sorted slots into byte ranges, ranges closer than
+  // BUFFER_RANGE_GAP are written at once
+  if (m_is_buffer_modified[index]) {
+    return;
+  }
+  std::vector<std::pair<std::size_t, std::size_t>> &ranges =
+    m_buffer_ranges[index];
+  for (std::size_t i = 0; i < slots.size(); ++i) {
+    std::size_t start = slots[i] * slot_size, end = start + slot_size;
+    if (!ranges.empty() && start <= ranges.back().second + BUFFER_RANGE_GAP
+        && start >= ranges.back().first) {
+      ranges.back().second = std::max(ranges.back().second, end);
+    }
+    else {
+      ranges.push_back(std::make_pair(start, end));
+    }
+  }
+}
+
 void Scene::attrib_buffers(CGAL::QGLViewer *viewer) {
   QMatrix4x4 mvMatrix, mvpMatrix;
   double mvMat[16], mvpMat[16];
@@ -693,6 +801,54 @@ void Scene::attrib_buffers(CGAL::QGLViewer *viewer) {
   rendering_program_with_light.release();
 }
 
+void Scene::draw_indexed_faces(CGAL::QGLViewer *viewer, int vao_index,
+    int index_buffer, const std::vector<GLuint> &indices,
+    const QColor &color) {
+  // the faces share their vertices, so the normal is computed per fragment
+  // (is_flat) and the plain color is a constant attribute
+  QMatrix4x4 fMatrix;
+  fMatrix.setToIdentity();
+  gl->glEnable(GL_LIGHTING);
+  gl->glEnable(GL_POLYGON_OFFSET_FILL);
+  gl->glPolygonOffset(1.0f, 1.0f);
+  vao[vao_index].bind();
+  attrib_buffers(viewer);
+  rendering_program_with_light.bind();
+  rendering_program_with_light.setUniformValue("is_selected", false);
+  rendering_program_with_light.setUniformValue("is_flat", true);
+  rendering_program_with_light.setUniformValue("f_matrix", fMatrix);
+  rendering_program_with_light.setAttributeValue(colorLocation_with_light,
+      GLfloat(color.redF()), GLfloat(color.greenF()), GLfloat(color.blueF()));
+  gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[index_buffer].bufferId());
+  gl->glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
+                     GL_UNSIGNED_INT, 0);
+  gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  rendering_program_with_light.setUniformValue("is_flat", false);
+  rendering_program_with_light.release();
+  vao[vao_index].release();
+  gl->glDisable(GL_POLYGON_OFFSET_FILL);
+}
+
+void Scene::draw_indexed_edges(CGAL::QGLViewer *viewer, int vao_index,
+    int index_buffer, const std::vector<GLuint> &indices,
+    GLfloat line_width, const QColor &color) {
+  QMatrix4x4 fMatrix;
+  fMatrix.setToIdentity();
+  gl->glDisable(GL_LIGHTING);
+  gl->glLineWidth(line_width);
+  vao[vao_index].bind();
+  attrib_buffers(viewer);
+  rendering_program.bind();
+  rendering_program.setUniformValue(colorLocation, color);
+  rendering_program.setUniformValue(fLocation, fMatrix);
+  gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[index_buffer].bufferId());
+  gl->glDrawElements(GL_LINES, static_cast<GLsizei>(indices.size()),
+                     GL_UNSIGNED_INT, 0);
+  gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  rendering_program.release();
+  vao[vao_index].release();
+}
+
 void Scene::draw(CGAL::QGLViewer *viewer) {
   if (!gl_init) {
     initGL();
@@ -704,6 +860,15 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
   QColor color;
   QMatrix4x4 fMatrix;
   fMatrix.setToIdentity();
+  // LOD: samples and links are limited to one per m_lod_pixels_per_element
+  // pixels of the projected scene, so more of them appear when zooming in
+  if (m_lod_pixels_per_element > 0) {
+    const CGAL::qglviewer::Camera *camera = viewer->camera();
+    double ratio = camera->pixelGLRatio(camera->sceneCenter());
+    double pixel_radius = ratio > 0.0 ? camera->sceneRadius() / ratio : 0.0;
+    m_lod_budget = static_cast<std::size_t>(std::min(1e9,
+        CGAL_PI * pixel_radius * pixel_radius / m_lod_pixels_per_element));
+  }
   // Input
   if (m_view_input) {
     if (pos_input_faces.size() > 0) {
@@ -721,6 +886,10 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       vao[VAOs::ka_Input_faces].release();
       gl->glDisable(GL_POLYGON_OFFSET_FILL);
     }
+    if (!idx_input_faces.empty()) {   // same color as in compute_elements()
+      draw_indexed_faces(viewer, VAOs::ka_Input_indexed_faces,
+          VBOs::kb_Input_face_indices, idx_input_faces, QColor(150, 150, 200));
+    }
     if (pos_input_boundaries.size() > 0) {
       gl->glDisable(GL_LIGHTING);
       gl->glLineWidth(0.5f);
@@ -745,7 +914,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_input_samples.size() / 3));
+        get_lod_vertex_count(pos_input_samples, 1));
       rendering_program.release();
       vao[VAOs::ka_Input_samples].release();
     }
@@ -770,6 +939,12 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.release();
       vao[VAOs::ka_Input_normal_edges].release();
     }
+    if (!idx_input_edges.empty() &&
+      m_render_type != k_classifications && m_view_mesh_edges) {
+      draw_indexed_edges(viewer, VAOs::ka_Input_indexed_edges,
+          VBOs::kb_Input_edge_indices, idx_input_edges,
+          pos_input_boundaries.empty() ? 1.0f : 2.0f, QColor(0, 0, 0));
+    }
     if (pos_input_special_edges.size() > 0 &&
       (m_render_type == k_classifications ||
       (m_view_minimal_angle && m_render_type == k_plain_faces))) {
@@ -804,6 +979,10 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       vao[VAOs::ka_Remesh_faces].release();
       gl->glDisable(GL_POLYGON_OFFSET_FILL);
     }
+    if (!idx_remesh_faces.empty()) {   // same color as in compute_elements()
+      draw_indexed_faces(viewer, VAOs::ka_Remesh_indexed_faces,
+          VBOs::kb_Remesh_face_indices, idx_remesh_faces, QColor(200, 150, 150));
+    }
     if (pos_remesh_boundaries.size() > 0) {
       gl->glDisable(GL_LIGHTING);
       gl->glLineWidth(0.5f);
@@ -828,7 +1007,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_remesh_samples.size() / 3));
+        get_lod_vertex_count(pos_remesh_samples, 1));
       rendering_program.release();
       vao[VAOs::ka_Remesh_samples].release();
     }
@@ -854,6 +1033,12 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.release();
       vao[VAOs::ka_Remesh_normal_edges].release();
     }
+    if (!idx_remesh_edges.empty() &&
+      m_render_type != k_classifications && m_view_mesh_edges) {
+      draw_indexed_edges(viewer, VAOs::ka_Remesh_indexed_edges,
+          VBOs::kb_Remesh_edge_indices, idx_remesh_edges,
+          pos_remesh_boundaries.empty() ? 1.0f : 2.0f, QColor(0, 0, 0));
+    }
     if (pos_remesh_special_edges.size() > 0 &&
       (m_render_type == k_classifications ||
       (m_view_minimal_angle && m_render_type == k_plain_faces))) {
@@ -885,7 +1070,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_face_in_start_points.size() / 3));
+        get_lod_vertex_count(pos_face_in_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Face_in_start].release();
     }
@@ -898,7 +1083,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_face_in_links.size() / 3));
+        get_lod_vertex_count(pos_face_in_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Face_in_links].release();
     }
@@ -911,7 +1096,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_face_in_end_points.size() / 3));
+        get_lod_vertex_count(pos_face_in_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Face_in_end].release();
     }
@@ -925,7 +1110,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_face_out_start_points.size() / 3));
+        get_lod_vertex_count(pos_face_out_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Face_out_start].release();
     }
@@ -938,7 +1123,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_face_out_links.size() / 3));
+        get_lod_vertex_count(pos_face_out_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Face_out_links].release();
     }
@@ -951,7 +1136,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_face_out_end_points.size() / 3));
+        get_lod_vertex_count(pos_face_out_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Face_out_end].release();
     }
@@ -964,7 +1149,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_edge_in_start_points.size() / 3));
+        get_lod_vertex_count(pos_edge_in_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Edge_in_start].release();
     }
@@ -977,7 +1162,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_edge_in_links.size() / 3));
+        get_lod_vertex_count(pos_edge_in_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Edge_in_links].release();
     }
@@ -990,7 +1175,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_edge_in_end_points.size() / 3));
+        get_lod_vertex_count(pos_edge_in_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Edge_in_end].release();
     }
@@ -1003,7 +1188,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_edge_out_start_points.size() / 3));
+        get_lod_vertex_count(pos_edge_out_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Edge_out_start].release();
     }
@@ -1016,7 +1201,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_edge_out_links.size() / 3));
+        get_lod_vertex_count(pos_edge_out_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Edge_out_links].release();
     }
@@ -1029,7 +1214,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_edge_out_end_points.size() / 3));
+        get_lod_vertex_count(pos_edge_out_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Edge_out_end].release();
     }
@@ -1043,7 +1228,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_vertex_in_start_points.size() / 3));
+        get_lod_vertex_count(pos_vertex_in_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Vertex_in_start].release();
     }
@@ -1056,7 +1241,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_vertex_in_links.size() / 3));
+        get_lod_vertex_count(pos_vertex_in_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Vertex_in_links].release();
     }
@@ -1069,7 +1254,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_vertex_in_end_points.size() / 3));
+        get_lod_vertex_count(pos_vertex_in_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Vertex_in_end].release();
     }
@@ -1083,7 +1268,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_vertex_out_start_points.size() / 3));
+        get_lod_vertex_count(pos_vertex_out_start_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Vertex_out_start].release();
     }
@@ -1096,7 +1281,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_LINES, 0,
-        static_cast<GLsizei>(pos_vertex_out_links.size() / 3));
+        get_lod_vertex_count(pos_vertex_out_links, 2));
       rendering_program.release();
       vao[VAOs::ka_Vertex_out_links].release();
     }
@@ -1109,7 +1294,7 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
       rendering_program.setUniformValue(colorLocation, color);
       rendering_program.setUniformValue(fLocation, fMatrix);
       gl->glDrawArrays(GL_POINTS, 0,
-        static_cast<GLsizei>(pos_vertex_out_end_points.size() / 3));
+        get_lod_vertex_count(pos_vertex_out_end_points, 1));
       rendering_program.release();
       vao[VAOs::ka_Vertex_out_end].release();
     }
@@ -1117,29 +1302,41 @@ void Scene::draw(CGAL::QGLViewer *viewer) {
 }
 
 void Scene::changed() {
+  if (m_worker_busy) {    // recomputed once the worker is done
+    return;
+  }
   compute_elements();
   are_buffers_initialized = false;
 }
 
 void Scene::compute_elements() {
+  // the buffers are rebuilt as a whole, except the indexed ones that record
+  // their modified ranges (see compute_indexed_elements()) and the links that
+  // are kept while unchanged (see stratify_links())
+  for (int i = 0; i < VBOs::kb_Face_in_start_points; ++i) {
+    if (i < VBOs::kb_Input_vertex_pos || i > VBOs::kb_Remesh_edge_indices) {
+      m_is_buffer_modified[i] = true;
+    }
+  }
   if (m_view_input && m_pInput != NULL) {
     // step 1: compute the faces
     Color face_color(150, 150, 200);
     compute_faces(true, face_color, &pos_input_faces, &pos_input_face_normals,
         &pos_input_face_colors, &pos_input_boundaries, &pos_input_samples);
+    stratify_samples(ks_Input_samples, &pos_input_samples);
     // step 2: compute the edges
     if (m_render_type == k_classifications) {
       compute_classified_edges(true, &pos_input_normal_edges,
                                &pos_input_special_edges);
     }
     else {
-      if (m_view_mesh_edges) {
-        compute_edges(true, &pos_input_normal_edges);
-      }
+      pos_input_normal_edges.resize(0);
       if (m_view_minimal_angle && m_render_type == k_plain_faces) {
         compute_min_radian_edges(true, &pos_input_special_edges);
       }
     }
+    // step 3: compute the indexed faces and edges, and their vertices
+    compute_indexed_elements(true);
   }
   if (m_view_remesh && m_pRemesh != NULL) {
     // step 1: compute the faces
@@ -1147,78 +1344,106 @@ void Scene::compute_elements() {
     compute_faces(false, face_color, &pos_remesh_faces, 
         &pos_remesh_face_normals, &pos_remesh_face_colors,
         &pos_remesh_boundaries, &pos_remesh_samples);
+    stratify_samples(ks_Remesh_samples, &pos_remesh_samples);
     // step 2: compute the edges
     if (m_render_type == k_classifications) {
       compute_classified_edges(false, &pos_remesh_normal_edges,
         &pos_remesh_special_edges);
     }
     else {
-      if (m_view_mesh_edges) {
-        compute_edges(false, &pos_remesh_normal_edges);
-      }
+      pos_remesh_normal_edges.resize(0);
       if (m_view_minimal_angle && m_render_type == k_plain_faces) {
         compute_min_radian_edges(false, &pos_remesh_special_edges);
       }
     }
+    // step 3: compute the indexed faces and edges, and their vertices
+    compute_indexed_elements(false);
   }
-  // step 3: compute samples and links
+  // step 4: compute samples and links. The start points are always computed
+  // since they define the stratified order shared by the end points and
+  // links. Links unchanged since they were stratified are kept as they are
   if (m_pInput != NULL && m_pRemesh != NULL
     && m_draw_type == DrawType::k_mesh) {
+    int views;
     // input
-    if (m_view_face_in_start_points) {    // face in links
+    views = get_link_views(m_view_face_in_start_points,
+      m_view_face_in_end_points, m_view_face_in_links);
+    if (views != 0 && !is_stratified_current(ks_Face_in_links, views)) {
       compute_face_start_points(true, &pos_face_in_start_points);
+      if (m_view_face_in_end_points) {
+        compute_face_end_points(true, &pos_face_in_end_points);
+      }
+      if (m_view_face_in_links) {
+        compute_face_links(true, &pos_face_in_links);
+      }
+      stratify_links(ks_Face_in_links, views, &pos_face_in_start_points,
+        &pos_face_in_end_points, &pos_face_in_links);
     }
-    if (m_view_face_in_end_points) {
-      compute_face_end_points(true, &pos_face_in_end_points);
-    }
-    if (m_view_face_in_links) {
-      compute_face_links(true, &pos_face_in_links);
-    }
-    if (m_view_edge_in_start_points) {    // edge in links
+    views = get_link_views(m_view_edge_in_start_points,
+      m_view_edge_in_end_points, m_view_edge_in_links);
+    if (views != 0 && !is_stratified_current(ks_Edge_in_links, views)) {
       compute_edge_start_points(true, &pos_edge_in_start_points);
+      if (m_view_edge_in_end_points) {
+        compute_edge_end_points(true, &pos_edge_in_end_points);
+      }
+      if (m_view_edge_in_links) {
+        compute_edge_links(true, &pos_edge_in_links);
+      }
+      stratify_links(ks_Edge_in_links, views, &pos_edge_in_start_points,
+        &pos_edge_in_end_points, &pos_edge_in_links);
     }
-    if (m_view_edge_in_end_points) {
-      compute_edge_end_points(true, &pos_edge_in_end_points);
-    }
-    if (m_view_edge_in_links) {
-      compute_edge_links(true, &pos_edge_in_links);
-    }
-    if (m_view_vertex_in_start_points) {  // vertex in links
+    views = get_link_views(m_view_vertex_in_start_points,
+      m_view_vertex_in_end_points, m_view_vertex_in_links);
+    if (views != 0 && !is_stratified_current(ks_Vertex_in_links, views)) {
       compute_vertex_start_points(true, &pos_vertex_in_start_points);
-    }
-    if (m_view_vertex_in_end_points) {
-      compute_vertex_end_points(true, &pos_vertex_in_end_points);
-    }
-    if (m_view_vertex_in_links) {
-      compute_vertex_links(true, &pos_vertex_in_links);
+      if (m_view_vertex_in_end_points) {
+        compute_vertex_end_points(true, &pos_vertex_in_end_points);
+      }
+      if (m_view_vertex_in_links) {
+        compute_vertex_links(true, &pos_vertex_in_links);
+      }
+      stratify_links(ks_Vertex_in_links, views, &pos_vertex_in_start_points,
+        &pos_vertex_in_end_points, &pos_vertex_in_links);
     }
     // remesh
-    if (m_view_face_out_start_points) {   // face out links
+    views = get_link_views(m_view_face_out_start_points,
+      m_view_face_out_end_points, m_view_face_out_links);
+    if (views != 0 && !is_stratified_current(ks_Face_out_links, views)) {
       compute_face_start_points(false, &pos_face_out_start_points);
+      if (m_view_face_out_end_points) {
+        compute_face_end_points(false, &pos_face_out_end_points);
+      }
+      if (m_view_face_out_links) {
+        compute_face_links(false, &pos_face_out_links);
+      }
+      stratify_links(ks_Face_out_links, views, &pos_face_out_start_points,
+        &pos_face_out_end_points, &pos_face_out_links);
     }
-    if (m_view_face_out_end_points) {
-      compute_face_end_points(false, &pos_face_out_end_points);
-    }
-    if (m_view_face_out_links) {
-      compute_face_links(false, &pos_face_out_links);
-    }
-    if (m_view_edge_out_start_points) {   // edge out links
+    views = get_link_views(m_view_edge_out_start_points,
+      m_view_edge_out_end_points, m_view_edge_out_links);
+    if (views != 0 && !is_stratified_current(ks_Edge_out_links, views)) {
       compute_edge_start_points(false, &pos_edge_out_start_points);
+      if (m_view_edge_out_end_points) {
+        compute_edge_end_points(false, &pos_edge_out_end_points);
+      }
+      if (m_view_edge_out_links) {
+        compute_edge_links(false, &pos_edge_out_links);
+      }
+      stratify_links(ks_Edge_out_links, views, &pos_edge_out_start_points,
+        &pos_edge_out_end_points, &pos_edge_out_links);
     }
-    if (m_view_edge_out_end_points) {
-      compute_edge_end_points(false, &pos_edge_out_end_points);
-    }
-    if (m_view_edge_out_links) {
-      compute_edge_links(false, &pos_edge_out_links);
-    }
-    if (m_view_vertex_out_start_points) { // vertex out links
+    views = get_link_views(m_view_vertex_out_start_points,
+      m_view_vertex_out_end_points, m_view_vertex_out_links);
+    if (views != 0 && !is_stratified_current(ks_Vertex_out_links, views)) {
       compute_vertex_start_points(false, &pos_vertex_out_start_points);
-    }
-    if (m_view_vertex_out_end_points) {
-      compute_vertex_end_points(false, &pos_vertex_out_end_points);
-    }
-    if (m_view_vertex_out_links) {
-      compute_vertex_links(false, &pos_vertex_out_links);
+      if (m_view_vertex_out_end_points) {
+        compute_vertex_end_points(false, &pos_vertex_out_end_points);
+      }
+      if (m_view_vertex_out_links) {
+        compute_vertex_links(false, &pos_vertex_out_links);
+      }
+      stratify_links(ks_Vertex_out_links, views, &pos_vertex_out_start_points,
+        &pos_vertex_out_end_points, &pos_vertex_out_links);
     }
   }
 }
@@ -1238,9 +1463,11 @@ void Scene::compute_faces(bool is_input, Color face_color,
   pos_samples->resize(0);
   switch (m_draw_type) {
   case DrawType::k_mesh:
-    compute_mesh_faces(is_input, face_color, sum_theta_value,
-        dihedral_theta_value, max_error_threshold_value, pos_faces,
-        pos_face_normals, pos_face_colors);
+    if (m_render_type != RenderType::k_plain_faces) {  // plain ones indexed
+      compute_mesh_faces(is_input, face_color, sum_theta_value,
+          dihedral_theta_value, max_error_threshold_value, pos_faces,
+          pos_face_normals, pos_face_colors);
+    }
     break;
   case DrawType::k_all_voronoi:
     compute_all_voronois(is_input, sum_theta_value, dihedral_theta_value,
@@ -1275,9 +1502,21 @@ void Scene::compute_mesh_faces(bool is_input, Color face_color,
   FT max_value = (sum_theta_value + 1) * (dihedral_theta_value + 1) - 1;
   const Mesh_properties *mesh_properties = get_mesh_properties(is_input);
   const Mesh &mesh = mesh_properties->get_mesh();
-  for (Mesh::Face_range::const_iterator fi = mesh.faces().begin();
-      fi != mesh.faces().end(); ++fi) {
-    face_descriptor fd = *fi;
+  // removed faces keep their slot as a degenerate triangle, so that a local
+  // operation only modifies the buffer ranges of the faces it touched
+  bool has_colors = m_render_type == RenderType::k_plain_faces ||
+    m_render_type == RenderType::k_ifi_faces ||
+    m_render_type == RenderType::k_mr_faces;
+  for (Mesh::size_type i = 0; i < mesh.num_faces(); ++i) {
+    face_descriptor fd(i);
+    if (mesh.is_removed(fd)) {
+      pos_faces->insert(pos_faces->end(), 9, 0.0f);
+      pos_face_normals->insert(pos_face_normals->end(), 9, 0.0f);
+      if (has_colors) {
+        pos_face_colors->insert(pos_face_colors->end(), 9, 0.0f);
+      }
+      continue;
+    }
     const Normal &normal = mesh_properties->get_face_normal(fd);
     halfedge_descriptor hd = mesh.halfedge(fd);
     vertex_descriptor vd = mesh.target(hd);
@@ -1337,18 +1576,8 @@ void Scene::compute_all_voronois(bool is_input, FT sum_theta_value,
     break;
   }
   // step 2: compute all sample cells and cell boundaries
-  const Mesh &mesh = mesh_properties->get_mesh();
-  for (Mesh::Face_range::const_iterator fi = mesh.faces().begin();
-      fi != mesh.faces().end(); ++fi) {
-    const Normal &normal = mesh_properties->get_face_normal(*fi);
-    Point_list samples;
-    Color_list colors;
-    get_all_sample_normalized_colors(is_input, *fi, min_value, max_value,
-                                     240, &samples, &colors);
-    Bvd bvd(mesh_properties->triangle(*fi));
-    bvd.compute_voronoi_cells_and_boundaries(samples, normal, colors,
-      pos_faces, pos_face_normals, pos_face_colors, pos_boundaries);
-  }
+  compute_cached_voronois(is_input, true, min_value, max_value, pos_faces,
+      pos_face_normals, pos_face_colors, pos_boundaries);
   // step 3: compute all samples
   compute_all_samples(is_input, pos_samples);
 }
@@ -1463,20 +1692,125 @@ void Scene::compute_face_voronois(bool is_input, FT sum_theta_value,
     break;
   }
   // step 2: compute face_voronoi cell and boundaries
+  compute_cached_voronois(is_input, false, min_value, max_value, pos_faces,
+      pos_face_normals, pos_face_colors, pos_boundaries);
+  // step 3: compute samples
+  compute_face_samples(is_input, pos_samples);
+}
+
+void Scene::compute_cached_voronois(bool is_input, bool all_samples,
+    FT min_value, FT max_value, std::vector<float> *pos_faces,
+    std::vector<float> *pos_face_normals, std::vector<float> *pos_face_colors,
+    std::vector<float> *pos_boundaries) const {
+  // step 1: collect the faces and make room for their cells
+  const Mesh_properties *mesh_properties = get_mesh_properties(is_input);
   const Mesh &mesh = mesh_properties->get_mesh();
-  for (Mesh::Face_range::const_iterator fi = mesh.faces().begin();
-      fi != mesh.faces().end(); ++fi) {
-    const Normal &normal = mesh_properties->get_face_normal(*fi);
+  std::vector<face_descriptor> faces(mesh.faces().begin(),
+                                     mesh.faces().end());
+  std::vector<Voronoi_cell_cache> &cells =
+      is_input ? m_input_voronoi_cells : m_remesh_voronoi_cells;
+  if (cells.size() != mesh.num_faces()) {
+    cells.resize(mesh.num_faces());
+  }
+  // step 2: recompute the cells of the faces whose signature changed. The
+  // samples and colors are cheap to collect, the Delaunay triangulation of
+  // the Bvd is not. Each face only writes to its own cache entry
+  auto compute_cell = [&](std::size_t i) {
+    face_descriptor fd = faces[i];
     Point_list samples;
     Color_list colors;
-    get_face_sample_normalized_colors(is_input, *fi, min_value, 
-                                      max_value, 240, &samples, &colors);
-    Bvd bvd(mesh_properties->triangle(*fi));
-    bvd.compute_voronoi_cells_and_boundaries(samples, normal, colors,
-      pos_faces, pos_face_normals, pos_face_colors, pos_boundaries);
+    if (all_samples) {
+      get_all_sample_normalized_colors(is_input, fd, min_value, max_value,
+                                       240, &samples, &colors);
+    }
+    else {
+      get_face_sample_normalized_colors(is_input, fd, min_value, max_value,
+                                        240, &samples, &colors);
+    }
+    std::size_t signature = calculate_voronoi_signature(is_input, fd,
+                                                        samples, colors);
+    Voronoi_cell_cache &cell = cells[fd.idx()];
+    if (cell.valid && cell.signature == signature) {
+      return;
+    }
+    cell.faces.clear();
+    cell.face_normals.clear();
+    cell.face_colors.clear();
+    cell.boundaries.clear();
+    Bvd bvd(mesh_properties->triangle(fd));
+    bvd.compute_voronoi_cells_and_boundaries(samples,
+        mesh_properties->get_face_normal(fd), colors, &cell.faces,
+        &cell.face_normals, &cell.face_colors, &cell.boundaries);
+    cell.signature = signature;
+    cell.valid = true;
+  };
+#ifdef CGAL_LINKED_WITH_TBB
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, faces.size()),
+    [&](const tbb::blocked_range<std::size_t> &range) {
+      for (std::size_t i = range.begin(); i != range.end(); ++i) {
+        compute_cell(i);
+      }
+    });
+#else
+  for (std::size_t i = 0; i < faces.size(); ++i) {
+    compute_cell(i);
+  }
+#endif
+  // step 3: concatenate the cells in face order
+  std::size_t nb_faces = 0, nb_boundaries = 0;
+  for (std::size_t i = 0; i < faces.size(); ++i) {
+    nb_faces += cells[faces[i].idx()].faces.size();
+    nb_boundaries += cells[faces[i].idx()].boundaries.size();
+  }
+  pos_faces->reserve(pos_faces->size() + nb_faces);
+  pos_face_normals->reserve(pos_face_normals->size() + nb_faces);
+  pos_face_colors->reserve(pos_face_colors->size() + nb_faces);
+  pos_boundaries->reserve(pos_boundaries->size() + nb_boundaries);
+  for (std::size_t i = 0; i < faces.size(); ++i) {
+    const Voronoi_cell_cache &cell = cells[faces[i].idx()];
+    pos_faces->insert(pos_faces->end(), cell.faces.begin(), cell.faces.end());
+    pos_face_normals->insert(pos_face_normals->end(),
+        cell.face_normals.begin(), cell.face_normals.end());
+    pos_face_colors->insert(pos_face_colors->end(),
+        cell.face_colors.begin(), cell.face_colors.end());
+    pos_boundaries->insert(pos_boundaries->end(),
+        cell.boundaries.begin(), cell.boundaries.end());
+  }
+}
+
+std::size_t Scene::calculate_voronoi_signature(bool is_input,
+    face_descriptor fd, const Point_list &samples,
+    const Color_list &colors) const {
+  // hashes everything the cell of fd depends on, so that changed links,
+  // geometry or colors (or a reused face descriptor) are all detected
+  const Mesh_properties *mesh_properties = get_mesh_properties(is_input);
+  const Mesh &mesh = mesh_properties->get_mesh();
+  std::size_t seed = 0;
+  boost::hash_combine(seed, static_cast<int>(m_draw_type));
+  boost::hash_combine(seed, static_cast<int>(m_render_type));
+  halfedge_descriptor hd = mesh.halfedge(fd);
+  for (int i = 0; i <= 2; ++i) {
+    const Point &p = mesh.point(mesh.target(hd));
+    boost::hash_combine(seed, p.x());
+    boost::hash_combine(seed, p.y());
+    boost::hash_combine(seed, p.z());
+    hd = mesh.next(hd);
   }
-  // step 3: compute samples
-  compute_face_samples(is_input, pos_samples);
+  const Normal &normal = mesh_properties->get_face_normal(fd);
+  boost::hash_combine(seed, normal.x());
+  boost::hash_combine(seed, normal.y());
+  boost::hash_combine(seed, normal.z());
+  for (Point_const_iter it = samples.begin(); it != samples.end(); ++it) {
+    boost::hash_combine(seed, it->x());
+    boost::hash_combine(seed, it->y());
+    boost::hash_combine(seed, it->z());
+  }
+  for (Color_const_iter it = colors.begin(); it != colors.end(); ++it) {
+    boost::hash_combine(seed, it->red());
+    boost::hash_combine(seed, it->green());
+    boost::hash_combine(seed, it->blue());
+  }
+  return seed;
 }
 
 void Scene::compute_edge_normal_dihedrals(bool is_input,
@@ -1565,7 +1899,8 @@ void Scene::compute_edge_sample_properties(bool is_input, FT sum_theta_value,
     for (auto cit = edge_out_links.begin();
       cit != edge_out_links.end(); ++cit) {
       const Link &link = *cit;
-      compute_point(link.second.first, pos_samples);
+      compute_point(mesh_properties->to_point(link.second.first),
+        pos_samples);
     }
     // step 2.2: compute the faces and edges
     Link_list_const_iter first = edge_out_links.cbegin(), second = first;
@@ -1573,8 +1908,9 @@ void Scene::compute_edge_sample_properties(bool is_input, FT sum_theta_value,
     Point_list points;
     points.push_back(mesh.point(mesh.source(hd)));
     for (; second != edge_out_links.cend(); ++first, ++second) {
-      points.push_back(CGAL::midpoint(first->second.first,
-        second->second.first));
+      points.push_back(CGAL::midpoint(
+        mesh_properties->to_point(first->second.first),
+        mesh_properties->to_point(second->second.first)));
     }
     points.push_back(mesh.point(mesh.target(hd)));
     Color_list colors;
@@ -1656,7 +1992,7 @@ void Scene::compute_all_samples(bool is_input,
         mesh_properties->get_halfedge_out_links(hd);
     for (auto it = edge_out_links.begin();
       it != edge_out_links.end(); ++it) {
-      const Point &p = it->second.first;
+      const Point &p = mesh_properties->to_point(it->second.first);
       compute_point(p, pos_samples);
     }
   }
@@ -1664,7 +2000,7 @@ void Scene::compute_all_samples(bool is_input,
   for (Mesh::Vertex_range::const_iterator vi = mesh.vertices().begin();
     vi != mesh.vertices().end(); ++vi) {
     const Link &link = mesh_properties->get_vertex_out_link(*vi);
-    const Point &p = link.second.first;
+    const Point &p = mesh_properties->to_point(link.second.first);
     compute_point(p, pos_samples);
   }
 }
@@ -1678,7 +2014,8 @@ void Scene::compute_face_samples(bool is_input,
     const Link_list &face_out_links = mesh_properties->get_face_out_links(*fi);
     for (auto it = face_out_links.begin(); it != face_out_links.end(); ++it) {
       const Link &link = *it;
-      compute_point(link.second.first, pos_samples);
+      compute_point(mesh_properties->to_point(link.second.first),
+        pos_samples);
     }
   }
 }
@@ -1731,17 +2068,18 @@ void Scene::get_all_sample_normalized_colors(bool is_input,
   const Link_list &face_out_links = mesh_properties->get_face_out_links(fd);
   for (auto it = face_out_links.begin(); it != face_out_links.end(); ++it) {
     const Link &link = *it;
-    if (disturbed_border_samples.find(link.second.first) ==
+    const Point &sample = mesh_properties->to_point(link.second.first);
+    if (disturbed_border_samples.find(sample) ==
       disturbed_border_samples.end()) {
       switch (m_render_type) {
       case RenderType::k_feature_intensity:
-        disturbed_border_samples[link.second.first] = link.first - 1.0;
+        disturbed_border_samples[sample] = link.first - 1.0;
         break;
       case RenderType::k_weight:
-        disturbed_border_samples[link.second.first] = link.first;
+        disturbed_border_samples[sample] = link.first;
         break;
       case RenderType::k_capacity:
-        disturbed_border_samples[link.second.first] = 1.0;
+        disturbed_border_samples[sample] = 1.0;
         break;
       default:
         break;
@@ -1814,7 +2152,7 @@ void Scene::get_face_sample_normalized_colors(bool is_input,
   const Link_list &face_out_links = mesh_properties->get_face_out_links(fd);
   FT capacity = mesh_properties->area(fd) / face_out_links.size();
   for (auto it = face_out_links.begin(); it != face_out_links.end(); ++it) {
-    samples->push_back(it->second.first);
+    samples->push_back(mesh_properties->to_point(it->second.first));
     switch (m_render_type) {
     case RenderType::k_feature_intensity:
       values.push_back(it->first / capacity - 1.0);
@@ -1865,8 +2203,9 @@ void Scene::get_disturbed_border_samples_with_weights(bool is_input,
     else {
       value = link.first;
     }
-    disturbed_border_samples->insert(std::make_pair(link.second.first + vec,
-                                     value));
+    disturbed_border_samples->insert(
+        std::make_pair(mesh_properties->to_point(link.second.first) + vec,
+          value));
     // step 2: add the edge samples
     halfedge_descriptor h = hd;
     if (mesh_properties->get_halfedge_normal_dihedral(h) == -1.0) {
@@ -1876,7 +2215,7 @@ void Scene::get_disturbed_border_samples_with_weights(bool is_input,
         mesh_properties->get_halfedge_out_links(h);
     for (Link_list_const_iter cit = edge_out_links.begin();
       cit != edge_out_links.end(); ++cit) {
-      const Point &p = cit->second.first;
+      const Point &p = mesh_properties->to_point(cit->second.first);
       vec = mesh.point(vd) - p;
       vec = vec * disturb_ratio;
       if (m_render_type == RenderType::k_capacity) {
@@ -1927,15 +2266,283 @@ void Scene::compute_vertices(bool is_input,
   }
 }
 
-void Scene::compute_edges(bool is_input, std::vector<float> *pos_edges) const {
-  pos_edges->resize(0);
-  const Mesh_properties* mesh_properties = get_mesh_properties(is_input);
+void Scene::compute_indexed_vertices(bool is_input,
+    std::vector<float> *pos_vertices) const {
+  // indexed by the vertex index
+  const Mesh &mesh = get_mesh_properties(is_input)->get_mesh();
+  pos_vertices->resize(3 * mesh.num_vertices());
+  for (Mesh::size_type i = 0; i < mesh.num_vertices(); ++i) {
+    compute_indexed_vertex(mesh, vertex_descriptor(i), &(*pos_vertices)[3 * i]);
+  }
+}
+
+void Scene::compute_indexed_faces(bool is_input,
+                                  std::vector<GLuint> *idx_faces) const {
+  // indexed by the face index
+  const Mesh &mesh = get_mesh_properties(is_input)->get_mesh();
+  idx_faces->resize(3 * mesh.num_faces());
+  for (Mesh::size_type i = 0; i < mesh.num_faces(); ++i) {
+    compute_indexed_face(mesh, face_descriptor(i), &(*idx_faces)[3 * i]);
+  }
+}
+
+void Scene::compute_indexed_edges(bool is_input,
+                                  std::vector<GLuint> *idx_edges) const {
+  // indexed by the edge index
+  const Mesh &mesh = get_mesh_properties(is_input)->get_mesh();
+  idx_edges->resize(2 * mesh.num_edges());
+  for (Mesh::size_type i = 0; i < mesh.num_edges(); ++i) {
+    compute_indexed_edge(mesh, edge_descriptor(i), &(*idx_edges)[2 * i]);
+  }
+}
+
+void Scene::compute_indexed_elements(bool is_input) {
+  // Each element has its slot in the indexed buffers, so only the slots of
+  // the elements modified by the local operations since the last call (and
+  // of the new ones) are rebuilt and written. Everything is rebuilt for
+  // another mesh, other views or after the elements were renumbered
+  Mesh_properties *mesh_properties = get_mesh_properties(is_input);
   const Mesh &mesh = mesh_properties->get_mesh();
-  for (Mesh::Edge_range::const_iterator ei = mesh.edges().begin();
-      ei != mesh.edges().end(); ++ei) {
-    halfedge_descriptor hd = mesh.halfedge(*ei);
-    compute_halfedge(mesh, hd, pos_edges);
+  std::vector<float> *pos_vertices =
+    is_input ? &pos_input_vertices : &pos_remesh_vertices;
+  std::vector<GLuint> *idx_faces =
+    is_input ? &idx_input_faces : &idx_remesh_faces;
+  std::vector<GLuint> *idx_edges =
+    is_input ? &idx_input_edges : &idx_remesh_edges;
+  int vertex_vbo = is_input ? VBOs::kb_Input_vertex_pos :
+                              VBOs::kb_Remesh_vertex_pos;
+  int face_vbo = is_input ? VBOs::kb_Input_face_indices :
+                            VBOs::kb_Remesh_face_indices;
+  int edge_vbo = is_input ? VBOs::kb_Input_edge_indices :
+                            VBOs::kb_Remesh_edge_indices;
+  bool has_faces = m_draw_type == k_mesh && m_render_type == k_plain_faces;
+  bool has_edges = m_render_type != k_classifications && m_view_mesh_edges;
+  Indexed_state &state = m_indexed_states[is_input ? 0 : 1];
+  bool is_incremental = state.mesh_properties == mesh_properties &&
+    state.has_faces == has_faces && state.has_edges == has_edges &&
+    !mesh_properties->all_elements_modified() &&
+    pos_vertices->size() <= 3 * mesh.num_vertices() &&
+    idx_faces->size() <= 3 * mesh.num_faces() &&
+    idx_edges->size() <= 2 * mesh.num_edges();
+  state.mesh_properties = mesh_properties;
+  state.has_faces = has_faces;
+  state.has_edges = has_edges;
+  if (!is_incremental) {
+    // step 1: rebuild all the slots
+    idx_faces->resize(0);
+    idx_edges->resize(0);
+    pos_vertices->resize(0);
+    if (has_faces) {
+      compute_indexed_faces(is_input, idx_faces);
+    }
+    if (has_edges) {
+      compute_indexed_edges(is_input, idx_edges);
+    }
+    if (has_faces || has_edges) {
+      compute_indexed_vertices(is_input, pos_vertices);
+    }
+    m_is_buffer_modified[vertex_vbo] = true;
+    m_is_buffer_modified[face_vbo] = true;
+    m_is_buffer_modified[edge_vbo] = true;
+  }
+  else if (has_faces || has_edges) {
+    // step 2: rebuild the modified slots only
+    std::vector<std::size_t> slots;
+    if (has_faces) {
+      collect_modified_slots(mesh_properties->get_modified_faces(),
+        idx_faces->size() / 3, mesh.num_faces(), &slots);
+      idx_faces->resize(3 * mesh.num_faces());
+      for (std::size_t i = 0; i < slots.size(); ++i) {
+        compute_indexed_face(mesh, face_descriptor(slots[i]),
+          &(*idx_faces)[3 * slots[i]]);
+      }
+      add_buffer_ranges(face_vbo, slots, 3 * sizeof(GLuint));
+    }
+    if (has_edges) {
+      collect_modified_slots(mesh_properties->get_modified_edges(),
+        idx_edges->size() / 2, mesh.num_edges(), &slots);
+      idx_edges->resize(2 * mesh.num_edges());
+      for (std::size_t i = 0; i < slots.size(); ++i) {
+        compute_indexed_edge(mesh, edge_descriptor(slots[i]),
+          &(*idx_edges)[2 * slots[i]]);
+      }
+      add_buffer_ranges(edge_vbo, slots, 2 * sizeof(GLuint));
+    }
+    collect_modified_slots(mesh_properties->get_modified_vertices(),
+      pos_vertices->size() / 3, mesh.num_vertices(), &slots);
+    pos_vertices->resize(3 * mesh.num_vertices());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+      compute_indexed_vertex(mesh, vertex_descriptor(slots[i]),
+        &(*pos_vertices)[3 * slots[i]]);
+    }
+    add_buffer_ranges(vertex_vbo, slots, 3 * sizeof(float));
   }
+  mesh_properties->clear_modified_elements();
+}
+
+void Scene::compute_indexed_vertex(const Mesh &mesh, vertex_descriptor vd,
+                                   float *slot) const {
+  // removed vertices are never referenced
+  if (mesh.is_removed(vd)) {
+    slot[0] = slot[1] = slot[2] = 0.0f;
+  }
+  else {
+    const Point &p = mesh.point(vd);
+    slot[0] = p.x();
+    slot[1] = p.y();
+    slot[2] = p.z();
+  }
+}
+
+void Scene::compute_indexed_face(const Mesh &mesh, face_descriptor fd,
+                                 GLuint *slot) const {
+  // removed faces keep their slot as a degenerate triangle
+  if (mesh.is_removed(fd)) {
+    slot[0] = slot[1] = slot[2] = 0;
+    return;
+  }
+  halfedge_descriptor hd = mesh.halfedge(fd);
+  for (int j = 0; j <= 2; ++j) {
+    slot[j] = static_cast<GLuint>(mesh.target(hd).idx());
+    hd = mesh.next(hd);
+  }
+}
+
+void Scene::compute_indexed_edge(const Mesh &mesh, edge_descriptor ed,
+                                 GLuint *slot) const {
+  // removed edges keep their slot as a degenerate segment
+  if (mesh.is_removed(ed)) {
+    slot[0] = slot[1] = 0;
+    return;
+  }
+  halfedge_descriptor hd = mesh.halfedge(ed);
+  slot[0] = static_cast<GLuint>(mesh.source(hd).idx());
+  slot[1] = static_cast<GLuint>(mesh.target(hd).idx());
+}
+
+void Scene::compute_stratified_order(const std::vector<float> &pos_points,
+    std::vector<std::size_t> *order) const {
+  // sort the points along a Morton curve, then take them in bit-reversed
+  // index order: every prefix of the result is spread over the whole curve
+  std::size_t n = pos_points.size() / 3;
+  order->resize(0);
+  if (n == 0) {
+    return;
+  }
+  float min[3], max[3];
+  for (int j = 0; j < 3; ++j) {
+    min[j] = max[j] = pos_points[j];
+  }
+  for (std::size_t i = 1; i < n; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      min[j] = std::min(min[j], pos_points[3 * i + j]);
+      max[j] = std::max(max[j], pos_points[3 * i + j]);
+    }
+  }
+  std::vector<std::pair<unsigned int, std::size_t> > codes(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    unsigned int code = 0;
+    for (int j = 0; j < 3; ++j) {   // 10 bits per axis, interleaved
+      float extent = max[j] - min[j];
+      unsigned int cell = extent > 0.0f ? static_cast<unsigned int>(
+          1023.0f * (pos_points[3 * i + j] - min[j]) / extent) : 0;
+      for (int b = 0; b < 10; ++b) {
+        code |= ((cell >> b) & 1u) << (3 * b + j);
+      }
+    }
+    codes[i] = std::make_pair(code, i);
+  }
+  std::sort(codes.begin(), codes.end());
+  int nb_bits = 0;
+  while ((std::size_t(1) << nb_bits) < n) {
+    ++nb_bits;
+  }
+  order->reserve(n);
+  std::size_t reversed = 0;       // k with its nb_bits bits reversed
+  for (std::size_t k = 0; k < (std::size_t(1) << nb_bits); ++k) {
+    if (reversed < n) {
+      order->push_back(codes[reversed].second);
+    }
+    std::size_t bit = (std::size_t(1) << nb_bits) >> 1;
+    while (bit != 0 && (reversed & bit)) {
+      reversed ^= bit;
+      bit >>= 1;
+    }
+    reversed |= bit;
+  }
+}
+
+void Scene::apply_order(const std::vector<std::size_t> &order,
+    int nb_floats_per_element, std::vector<float> *pos) const {
+  if (pos->size() != order.size() * nb_floats_per_element) {
+    return;     // not computed for the current links
+  }
+  std::vector<float> ordered;
+  ordered.reserve(pos->size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    std::vector<float>::const_iterator it =
+        pos->begin() + order[i] * nb_floats_per_element;
+    ordered.insert(ordered.end(), it, it + nb_floats_per_element);
+  }
+  pos->swap(ordered);
+}
+
+const std::vector<std::size_t>& Scene::get_stratified_order(int set,
+    int key, const std::vector<float> &pos_points) {
+  // the order of the set is only recomputed if the links changed
+  Stratified_order &stratified = m_stratified_orders[set];
+  unsigned int generation =
+    m_minangle_remesh.get_remesher()->get_links_generation();
+  if (stratified.key != key || stratified.generation != generation ||
+      stratified.order.size() != pos_points.size() / 3) {
+    compute_stratified_order(pos_points, &stratified.order);
+    stratified.generation = generation;
+    stratified.key = key;
+  }
+  return stratified.order;
+}
+
+bool Scene::is_stratified_current(int set, int key) const {
+  const Stratified_order &stratified = m_stratified_orders[set];
+  return stratified.key == key && stratified.generation ==
+    m_minangle_remesh.get_remesher()->get_links_generation();
+}
+
+void Scene::stratify_samples(int set, std::vector<float> *pos_samples) {
+  // which samples are drawn depends on the draw type
+  const std::vector<std::size_t> &order =
+    get_stratified_order(set, m_draw_type, *pos_samples);
+  apply_order(order, 3, pos_samples);
+}
+
+void Scene::stratify_links(int set, int views,
+    std::vector<float> *pos_start_points, std::vector<float> *pos_end_points,
+    std::vector<float> *pos_links) {
+  // the i-th start point, end point and link belong to the same link. The
+  // buffers of the set are written at the next upload
+  const std::vector<std::size_t> &order =
+    get_stratified_order(set, views, *pos_start_points);
+  if (views & 2) {
+    apply_order(order, 3, pos_end_points);
+  }
+  if (views & 4) {
+    apply_order(order, 6, pos_links);
+  }
+  apply_order(order, 3, pos_start_points);
+  int first_vbo = VBOs::kb_Face_in_start_points + 3 * (set - ks_Face_in_links);
+  for (int i = 0; i < 3; ++i) {
+    m_is_buffer_modified[first_vbo + i] = true;
+  }
+}
+
+GLsizei Scene::get_lod_vertex_count(const std::vector<float> &pos,
+                                    int nb_vertices_per_element) const {
+  // the first m_lod_budget elements of a stratified buffer
+  std::size_t nb_elements = pos.size() / (3 * nb_vertices_per_element);
+  if (m_lod_pixels_per_element > 0) {
+    nb_elements = std::min(nb_elements, m_lod_budget);
+  }
+  return static_cast<GLsizei>(nb_elements * nb_vertices_per_element);
 }
 
 void Scene::compute_min_radian_edges(bool is_input,
@@ -1996,7 +2603,8 @@ void Scene::compute_face_start_points(bool is_input,
     for (auto it = face_out_links.begin();
       it != face_out_links.end(); ++it) {
       const Link &link = *it;
-      compute_point(link.second.first, pos_face_start_point);
+      compute_point(mesh_properties->to_point(link.second.first),
+        pos_face_start_point);
     }
   }
 }
@@ -2012,7 +2620,8 @@ void Scene::compute_face_end_points(bool is_input,
     for (auto it = face_out_links.begin();
       it != face_out_links.end(); ++it) {
       const Link &link = *it;
-      compute_point(link.second.second, pos_face_end_point);
+      compute_point(mesh_properties->to_point(link.second.second),
+        pos_face_end_point);
     }
   }
 }
@@ -2028,8 +2637,8 @@ void Scene::compute_face_links(bool is_input,
     for (auto it = face_out_links.begin();
       it != face_out_links.end(); ++it) {
       const Link &link = *it;
-      const Point &p = link.second.first;
-      const Point &q = link.second.second;
+      const Point &p = mesh_properties->to_point(link.second.first);
+      const Point &q = mesh_properties->to_point(link.second.second);
       compute_segment(p, q, pos_face_links);
     }
   }
@@ -2051,7 +2660,8 @@ void Scene::compute_edge_start_points(bool is_input,
     for (auto it = edge_out_links.begin();
       it != edge_out_links.end(); ++it) {
       const Link &link = *it;
-      compute_point(link.second.first, pos_edge_start_points);
+      compute_point(mesh_properties->to_point(link.second.first),
+        pos_edge_start_points);
     }
   }
 }
@@ -2072,7 +2682,8 @@ void Scene::compute_edge_end_points(bool is_input,
     for (auto it = edge_out_links.begin();
       it != edge_out_links.end(); ++it) {
       const Link &link = *it;
-      compute_point(link.second.second, pos_edge_end_points);
+      compute_point(mesh_properties->to_point(link.second.second),
+        pos_edge_end_points);
     }
   }
 }
@@ -2093,8 +2704,8 @@ void Scene::compute_edge_links(bool is_input,
     for (auto it = edge_out_links.begin();
       it != edge_out_links.end(); ++it) {
       const Link &link = *it;
-      const Point &p = link.second.first;
-      const Point &q = link.second.second;
+      const Point &p = mesh_properties->to_point(link.second.first);
+      const Point &q = mesh_properties->to_point(link.second.second);
       compute_segment(p, q, pos_edge_links);
     }
   }
@@ -2108,7 +2719,8 @@ void Scene::compute_vertex_start_points(bool is_input,
   for (Mesh::Vertex_range::const_iterator vi = mesh.vertices().begin();
     vi != mesh.vertices().end(); ++vi) {
     const Link &link = mesh_properties->get_vertex_out_link(*vi);
-    compute_point(link.second.first, pos_vertex_start_points);
+    compute_point(mesh_properties->to_point(link.second.first),
+        pos_vertex_start_points);
   }
 }
 
@@ -2120,7 +2732,8 @@ void Scene::compute_vertex_end_points(bool is_input,
   for (Mesh::Vertex_range::const_iterator vi = mesh.vertices().begin();
     vi != mesh.vertices().end(); ++vi) {
     const Link &link = mesh_properties->get_vertex_out_link(*vi);
-    compute_point(link.second.second, pos_vertex_end_points);
+    compute_point(mesh_properties->to_point(link.second.second),
+        pos_vertex_end_points);
   }
 }
 
@@ -2132,8 +2745,8 @@ void Scene::compute_vertex_links(bool is_input,
   for (Mesh::Vertex_range::const_iterator vi = mesh.vertices().begin();
       vi != mesh.vertices().end(); ++vi) {
     const Link &link = mesh_properties->get_vertex_out_link(*vi);
-    const Point &p = link.second.first;
-    const Point &q = link.second.second;
+    const Point &p = mesh_properties->to_point(link.second.first);
+    const Point &q = mesh_properties->to_point(link.second.second);
     compute_segment(p, q, pos_vertex_links);
   }
 }
@@ -2419,94 +3032,133 @@ bool Scene::open_surface_mesh(QString file_name, Mesh *mesh) const {
 }
 
 bool Scene::open(QString file_name) {
-  // step 1: open the file, construct the mesh and crease halfedges
-  Mesh *mesh = new Mesh();
-  bool suc = open_surface_mesh(file_name, mesh);
-  if (!suc) {
-    delete mesh;
+  if (m_worker_busy) {
+    std::cout << "Please wait until the running operation is done"
+      << std::endl;
     return false;
   }
-  // step 2: set the m_pInput and m_pRemesh
-  if (m_pInput != NULL) {
-    m_minangle_remesh.delete_input();
-    delete m_pInput;
-  }
-  if (m_pRemesh != NULL) {
-    m_minangle_remesh.delete_remesh();
-    delete m_pRemesh;
-  }
-  m_pInput = mesh;
-  normalize(1.0, m_pInput);
-  m_minangle_remesh.set_input(m_pInput, true);
-  m_target_edge_length = calculate_input_edge_length();
-  update_bbox();
-  m_pRemesh = new Mesh(*m_pInput);
-  m_minangle_remesh.set_remesh(m_pRemesh, false);
-  reset_draw_render_types();
-  m_view_input = false;
-  m_view_remesh = true;
-
-  changed();
+  m_loading_succeeded = false;
+  run_in_worker([this, file_name]() {
+    // step 1: open the file, construct the mesh and crease halfedges
+    Mesh *mesh = read_mesh(file_name);
+    if (mesh == NULL) {
+      return;
+    }
+    // step 2: set the m_pInput and m_pRemesh
+    m_loading_stage = k_preprocessing_input;
+    if (m_pInput != NULL) {
+      m_minangle_remesh.delete_input();
+      delete m_pInput;
+    }
+    if (m_pRemesh != NULL) {
+      m_minangle_remesh.delete_remesh();
+      delete m_pRemesh;
+    }
+    m_pInput = mesh;
+    normalize(1.0, m_pInput);
+    m_minangle_remesh.set_input(m_pInput, true);
+    m_loading_stage = k_preprocessing_remesh;
+    m_pRemesh = new Mesh(*m_pInput);
+    m_minangle_remesh.set_remesh(m_pRemesh, false);
+    m_loading_succeeded = true;
+  }, [this, file_name]() {
+    // step 3: switch the view to the new model
+    if (m_loading_succeeded) {
+      m_target_edge_length = calculate_input_edge_length();
+      update_bbox();
+      reset_draw_render_types();
+      m_view_input = false;
+      m_view_remesh = true;
+    }
+    finish_loading(file_name);
+  });
   return true;
 }
 
 bool Scene::open_input(QString file_name) {
-  // step 1: open the file, construct the mesh and crease halfedges
-  Mesh *mesh = new Mesh();
-  bool suc = open_surface_mesh(file_name, mesh);
-  if (!suc) {
-    delete mesh;
+  if (m_worker_busy) {
+    std::cout << "Please wait until the running operation is done"
+      << std::endl;
     return false;
   }
-  // step 2: set the m_pInput, and m_pRemesh if necessary
-  if (m_pInput != NULL) {
-    m_minangle_remesh.delete_input();
-    delete m_pInput;
-  }
-  m_pInput = mesh;
-  normalize(1.0, m_pInput);
-  m_minangle_remesh.set_input(m_pInput, true);
-  m_target_edge_length = calculate_input_edge_length();
-  update_bbox();
-  if (m_pRemesh == NULL) {
-    m_pRemesh = new Mesh(*m_pInput);
-    m_minangle_remesh.set_remesh(m_pRemesh, false);
-  }
-  reset_draw_render_types();
-  m_view_input = true;
-  m_view_remesh = false;
-
-  changed();
+  m_loading_succeeded = false;
+  run_in_worker([this, file_name]() {
+    // step 1: open the file, construct the mesh and crease halfedges
+    Mesh *mesh = read_mesh(file_name);
+    if (mesh == NULL) {
+      return;
+    }
+    // step 2: set the m_pInput, and m_pRemesh if necessary
+    m_loading_stage = k_preprocessing_input;
+    if (m_pInput != NULL) {
+      m_minangle_remesh.delete_input();
+      delete m_pInput;
+    }
+    m_pInput = mesh;
+    normalize(1.0, m_pInput);
+    m_minangle_remesh.set_input(m_pInput, true);
+    if (m_pRemesh == NULL) {
+      m_loading_stage = k_preprocessing_remesh;
+      m_pRemesh = new Mesh(*m_pInput);
+      m_minangle_remesh.set_remesh(m_pRemesh, false);
+    }
+    m_loading_succeeded = true;
+  }, [this, file_name]() {
+    // step 3: switch the view to the new model
+    if (m_loading_succeeded) {
+      m_target_edge_length = calculate_input_edge_length();
+      update_bbox();
+      reset_draw_render_types();
+      m_view_input = true;
+      m_view_remesh = false;
+    }
+    finish_loading(file_name);
+  });
   return true;
 }
 
 bool Scene::open_remesh(QString file_name) {
-  // step 1: open the file, construct the mesh and crease_halfedges
-  Mesh *mesh = new Mesh();
-  bool suc = open_surface_mesh(file_name, mesh);
-  if (!suc) {
-    delete mesh;
+  if (m_worker_busy) {
+    std::cout << "Please wait until the running operation is done"
+      << std::endl;
     return false;
   }
-  // step 2: set the m_pRemesh, and m_pInput if necessary
-  if (m_pRemesh != NULL) {
-    m_minangle_remesh.delete_remesh();
-    delete m_pRemesh;
-  }
-  m_pRemesh = mesh;
-  if (m_pInput == NULL) {
-    normalize(1.0, m_pRemesh);
-    m_pInput = new Mesh(*m_pRemesh);
-    m_minangle_remesh.set_input(m_pInput, false);
-    m_target_edge_length = calculate_input_edge_length();
-    update_bbox();
-  }
-  m_minangle_remesh.set_remesh(m_pRemesh, true);
-  reset_draw_render_types();
-  m_view_input = false;
-  m_view_remesh = true;
-
-  changed();
+  m_loading_succeeded = false;
+  bool new_input = m_pInput == NULL;
+  run_in_worker([this, file_name]() {
+    // step 1: open the file, construct the mesh and crease_halfedges
+    Mesh *mesh = read_mesh(file_name);
+    if (mesh == NULL) {
+      return;
+    }
+    // step 2: set the m_pRemesh, and m_pInput if necessary
+    if (m_pRemesh != NULL) {
+      m_minangle_remesh.delete_remesh();
+      delete m_pRemesh;
+    }
+    m_pRemesh = mesh;
+    if (m_pInput == NULL) {
+      m_loading_stage = k_preprocessing_input;
+      normalize(1.0, m_pRemesh);
+      m_pInput = new Mesh(*m_pRemesh);
+      m_minangle_remesh.set_input(m_pInput, false);
+    }
+    m_loading_stage = k_preprocessing_remesh;
+    m_minangle_remesh.set_remesh(m_pRemesh, true);
+    m_loading_succeeded = true;
+  }, [this, file_name, new_input]() {
+    // step 3: switch the view to the new model
+    if (m_loading_succeeded) {
+      if (new_input) {
+        m_target_edge_length = calculate_input_edge_length();
+        update_bbox();
+      }
+      reset_draw_render_types();
+      m_view_input = false;
+      m_view_remesh = true;
+    }
+    finish_loading(file_name);
+  });
   return true;
 }
 
@@ -2926,8 +3578,8 @@ void Scene::generate_links() {
     return;
   }
   else {
-    m_minangle_remesh.generate_samples_and_links();
-    changed();
+    run_in_worker([this]() {
+      m_minangle_remesh.generate_samples_and_links(); });
   }
 }
 
@@ -2948,9 +3600,8 @@ void Scene::minangle_remeshing() {
     std::cout << "Please open a file first" << std::endl;
   }
   else {
-    m_minangle_remesh.minangle_remeshing();
     reset_draw_render_types();
-    changed();
+    run_in_worker([this]() { m_minangle_remesh.minangle_remeshing(); });
   }
 }
 
@@ -2959,9 +3610,8 @@ void Scene::initial_mesh_simplification() {
     std::cout << "Please open a file first" << std::endl;
   }
   else {
-    m_minangle_remesh.initial_mesh_simplification();
     reset_draw_render_types();
-    changed();
+    run_in_worker([this]() { m_minangle_remesh.initial_mesh_simplification(); });
   }
 }
 
@@ -2992,9 +3642,8 @@ void Scene::maximize_minimal_angle() {
     std::cout << "Please open a file first" << std::endl;
   }
   else {
-    m_minangle_remesh.maximize_minimal_angle();
     reset_draw_render_types();
-    changed();
+    run_in_worker([this]() { m_minangle_remesh.maximize_minimal_angle(); });
   }
 }
 
@@ -3003,10 +3652,184 @@ void Scene::final_vertex_relocation() {
     std::cout << "Please open a file first" << std::endl;
   }
   else {
-    m_minangle_remesh.final_vertex_relocation();
+    reset_draw_render_types();
+    run_in_worker([this]() { m_minangle_remesh.final_vertex_relocation(); });
+  }
+}
+
+void Scene::cancel_remeshing() {
+  if (m_worker_busy) {
+    std::cout << std::endl << "Cancelling..." << std::endl;
+    m_cancel_requested = true;
+  }
+}
+
+void Scene::timerEvent(QTimerEvent *event) {
+  // step 0: report the loading stage
+  int loading_stage = m_loading_stage;
+  if (loading_stage != m_reported_loading_stage) {
+    m_reported_loading_stage = loading_stage;
+    if (loading_stage != k_not_loading) {
+      emit loading_progress(get_loading_message(loading_stage));
+    }
+  }
+  // step 1: draw the latest preview of the remesh
+  if (m_preview_ready.exchange(false)) {
+    {
+      std::lock_guard<std::mutex> lock(m_preview_mutex);
+      pos_remesh_vertices.swap(m_preview_vertices);
+      idx_remesh_faces.swap(m_preview_faces);
+      idx_remesh_edges.swap(m_preview_edges);
+    }
+    m_indexed_states[1] = Indexed_state();    // rebuilt when finished
+    for (int i = 0; i < VBOs::kb_NbOfVbos; ++i) {
+      m_is_buffer_modified[i] = true;
+    }
+    pos_remesh_faces.resize(0);
+    pos_remesh_face_normals.resize(0);
+    pos_remesh_face_colors.resize(0);
+    pos_remesh_boundaries.resize(0);
+    pos_remesh_samples.resize(0);
+    pos_remesh_normal_edges.resize(0);
+    pos_remesh_special_edges.resize(0);
+    are_buffers_initialized = false;
+    emit preview_updated();
+  }
+  // step 2: hand the remesher back to the GUI thread. A preview published
+  // after step 1 is older than the finished remesh, drop it
+  if (m_operation_finished.exchange(false)) {
+    {
+      std::lock_guard<std::mutex> lock(m_preview_mutex);
+      m_preview_ready = false;
+      std::vector<float>().swap(m_preview_vertices);
+      std::vector<GLuint>().swap(m_preview_faces);
+      std::vector<GLuint>().swap(m_preview_edges);
+    }
+    m_worker_busy = false;
+    if (m_on_operation_finished) {
+      std::function<void()> on_finished;
+      on_finished.swap(m_on_operation_finished);
+      on_finished();
+    }
     reset_draw_render_types();
     changed();
+    emit remeshing_finished();
+  }
+}
+
+void Scene::run_in_worker(const std::function<void()> &command,
+                          const std::function<void()> &on_finished) {
+  if (m_worker_busy) {
+    std::cout << "Please wait until the running operation is done"
+      << std::endl;
+    return;
+  }
+  m_worker_busy = true;
+  m_cancel_requested = false;
+  m_on_operation_finished = on_finished;      // run by timerEvent()
+  std::lock_guard<std::mutex> lock(m_worker_mutex);
+  if (!m_worker.joinable()) {
+    m_worker = std::thread(&Scene::worker_loop, this);
+  }
+  m_worker_command = command;
+  m_worker_condition.notify_one();
+}
+
+void Scene::worker_loop() {
+  for (;;) {
+    std::function<void()> command;
+    {
+      std::unique_lock<std::mutex> lock(m_worker_mutex);
+      m_worker_condition.wait(lock, [this]() {
+        return m_worker_stop || m_worker_command; });
+      if (m_worker_stop) {
+        return;
+      }
+      command.swap(m_worker_command);
+    }
+    m_nb_unpublished_operations = 0;
+    m_last_preview_time = std::chrono::steady_clock::now();
+    command();
+    m_operation_finished = true;
+  }
+}
+
+bool Scene::report_progress() {
+  // the remesh is consistent here, publish it if it is time to
+  if (m_cancel_requested) {
+    return false;
+  }
+  ++m_nb_unpublished_operations;
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (m_nb_unpublished_operations >= m_preview_operation_count ||
+    now - m_last_preview_time >=
+    std::chrono::milliseconds(m_preview_interval)) {
+    publish_preview();
+    m_nb_unpublished_operations = 0;
+    m_last_preview_time = now;
+  }
+  return true;
+}
+
+void Scene::publish_preview() {
+  // only the indexed plain faces and mesh edges are previewed
+  std::vector<float> vertices;
+  std::vector<GLuint> faces, edges;
+  compute_indexed_vertices(false, &vertices);
+  compute_indexed_faces(false, &faces);
+  if (m_view_mesh_edges) {
+    compute_indexed_edges(false, &edges);
   }
+  std::lock_guard<std::mutex> lock(m_preview_mutex);
+  m_preview_vertices.swap(vertices);
+  m_preview_faces.swap(faces);
+  m_preview_edges.swap(edges);
+  m_preview_ready = true;
+}
+
+Mesh* Scene::read_mesh(QString file_name) {
+  m_loading_memory_estimate = 0;
+  m_loading_stage = k_reading;
+  Mesh *mesh = new Mesh();
+  if (!open_surface_mesh(file_name, mesh)) {
+    delete mesh;
+    return NULL;
+  }
+  // the input and the remesh are both built from the mesh
+  m_loading_memory_estimate =
+    2 * Mesh_properties::estimate_memory_usage(*mesh);
+  std::cout << "Estimated memory usage: "
+    << (m_loading_memory_estimate >> 20) << " MB" << std::endl;
+  return mesh;
+}
+
+QString Scene::get_loading_message(int stage) const {
+  QString message;
+  switch (stage) {
+  case k_reading:
+    message = "Reading the file";
+    break;
+  case k_preprocessing_input:
+    message = "Computing the input normals and feature intensities";
+    break;
+  case k_preprocessing_remesh:
+    message = "Computing the remesh properties";
+    break;
+  default:
+    break;
+  }
+  message += QString(" (%1/%2)").arg(stage).arg(int(k_nb_loading_stages));
+  std::size_t memory = m_loading_memory_estimate;
+  if (memory > 0) {
+    message += QString(", about %1 MB").arg(qulonglong(memory >> 20));
+  }
+  return message;
+}
+
+void Scene::finish_loading(QString file_name) {
+  m_loading_stage = k_not_loading;
+  m_reported_loading_stage = k_not_loading;
+  emit file_opened(file_name, m_loading_succeeded);
 }
 
 void Scene::update_feature_intensities() {
@@ -10,6 +10,14 @@
 //#include <CGAL/Qt/manipulatedFrame.h>
 //#include <CGAL/Qt/qglviewer.h>
 
+// C/C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 // local
 #include "Viewer.h"
 #include "types.h"
@@ -38,7 +46,8 @@ class Scene : public QObject {
   void initGL();
   void draw(CGAL::QGLViewer *viewer);
 
-  // 2) file process
+  // 2) file process (files are read and preprocessed in the background, the
+  // previous model is drawn until file_opened() is emitted)
   bool open(QString file_name);
   bool open_input(QString file_name);
   bool open_remesh(QString file_name);
@@ -54,6 +63,20 @@ class Scene : public QObject {
 
   void set_smooth_iteration_count(int value) { m_smooth_iteration_count = value; }
 
+  // background remeshing preview rate (every N operations or T ms)
+  int get_preview_operation_count() const { return m_preview_operation_count; }
+
+  void set_preview_operation_count(int value) { m_preview_operation_count = value; }
+
+  int get_preview_interval() const { return m_preview_interval; }
+
+  void set_preview_interval(int value) { m_preview_interval = value; }
+
+  // level of detail of samples and links (screen pixels per element, 0: all)
+  int get_lod_pixels_per_element() const { return m_lod_pixels_per_element; }
+
+  void set_lod_pixels_per_element(int value) { m_lod_pixels_per_element = value; }
+
   double get_max_error_threshold() const {
     return m_minangle_remesh.get_remesher()->get_max_error_threshold();
   }
@@ -434,6 +457,7 @@ class Scene : public QObject {
   void increase_minimal_angle();
   void maximize_minimal_angle();
   void final_vertex_relocation();
+  void cancel_remeshing();
 
   // 6) operations (may need update)
   void update_feature_intensities();
@@ -443,16 +467,40 @@ class Scene : public QObject {
     return m_minangle_remesh.get_remesher()->get_links_initialized();
   }
 
+  bool is_worker_busy() const { return m_worker_busy; }
+
   // 8) utilizations
   int get_optimize_type_index(OptimizeType ot) const;
 
   OptimizeType get_optimize_type(int index) const;
 
+ signals:
+  void preview_updated();       // a new remesh preview is ready to be drawn
+  void remeshing_finished();    // the background operation is done
+  void loading_progress(QString message);   // a new loading stage started
+  void file_opened(QString file_name, bool succeeded);
+
+ protected:
+  void timerEvent(QTimerEvent *event);
+
  private:
    // 1) for rendering
   void compile_shaders();
   void attrib_buffers(CGAL::QGLViewer*);
   void initialize_buffers();                      // initialize buffers
+  template <typename T>
+  void upload_buffer(int index, const std::vector<T> &data) {
+    upload_buffer(index, data.data(), data.size() * sizeof(T));
+  }
+  void upload_buffer(int index, const void *data, std::size_t size);
+  void add_buffer_ranges(int index, const std::vector<std::size_t> &slots,
+                         std::size_t slot_size);
+  void draw_indexed_faces(CGAL::QGLViewer *viewer, int vao_index,
+      int index_buffer, const std::vector<GLuint> &indices,
+      const QColor &color);
+  void draw_indexed_edges(CGAL::QGLViewer *viewer, int vao_index,
+      int index_buffer, const std::vector<GLuint> &indices,
+      GLfloat line_width, const QColor &color);
   void changed();                                 // compute elements
   void set_draw_render_types(DrawType draw_type, RenderType render_type);
   void reset_draw_render_types();
@@ -488,6 +536,13 @@ class Scene : public QObject {
       std::vector<float> *pos_face_normals, 
       std::vector<float> *pos_face_colors, std::vector<float> *pos_boundaries,
       std::vector<float> *pos_samples) const;
+  void compute_cached_voronois(bool is_input, bool all_samples,
+      FT min_value, FT max_value, std::vector<float> *pos_faces,
+      std::vector<float> *pos_face_normals,
+      std::vector<float> *pos_face_colors,
+      std::vector<float> *pos_boundaries) const;
+  std::size_t calculate_voronoi_signature(bool is_input, face_descriptor fd,
+      const Point_list &samples, const Color_list &colors) const;
   void compute_edge_normal_dihedrals(bool is_input, FT dihedral_theta_value, 
       std::vector<float> *pos_faces, std::vector<float> *pos_face_normals,
       std::vector<float> *pos_face_colors, 
@@ -517,9 +572,54 @@ class Scene : public QObject {
   void compute_face_samples(bool is_input,
                             std::vector<float> *pos_samples) const;
   void compute_vertices(bool is_input, std::vector<float> *pos_samples) const;
-  void compute_edges(bool is_input, std::vector<float> *pos_edges) const;
+  void compute_indexed_vertices(bool is_input,
+                                std::vector<float> *pos_vertices) const;
+  void compute_indexed_faces(bool is_input,
+                             std::vector<GLuint> *idx_faces) const;
+  void compute_indexed_edges(bool is_input,
+                             std::vector<GLuint> *idx_edges) const;
+  void compute_indexed_elements(bool is_input);
+  void compute_indexed_vertex(const Mesh &mesh, vertex_descriptor vd,
+                              float *slot) const;
+  void compute_indexed_face(const Mesh &mesh, face_descriptor fd,
+                            GLuint *slot) const;
+  void compute_indexed_edge(const Mesh &mesh, edge_descriptor ed,
+                            GLuint *slot) const;
+  template <typename Element>
+  void collect_modified_slots(const std::vector<Element> &modified,
+      std::size_t nb_old_slots, std::size_t nb_slots,
+      std::vector<std::size_t> *slots) const {
+    // the slots of the modified elements and of the new ones, sorted
+    slots->resize(0);
+    for (std::size_t i = 0; i < modified.size(); ++i) {
+      if (static_cast<std::size_t>(modified[i].idx()) < nb_slots) {
+        slots->push_back(modified[i].idx());
+      }
+    }
+    for (std::size_t i = nb_old_slots; i < nb_slots; ++i) {
+      slots->push_back(i);
+    }
+    std::sort(slots->begin(), slots->end());
+    slots->erase(std::unique(slots->begin(), slots->end()), slots->end());
+  }
   void compute_min_radian_edges(bool is_input,
       std::vector<float> *pos_min_radian_edges) const;
+  void compute_stratified_order(const std::vector<float> &pos_points,
+                                std::vector<std::size_t> *order) const;
+  void apply_order(const std::vector<std::size_t> &order,
+      int nb_floats_per_element, std::vector<float> *pos) const;
+  const std::vector<std::size_t>& get_stratified_order(int set, int key,
+      const std::vector<float> &pos_points);
+  bool is_stratified_current(int set, int key) const;
+  void stratify_samples(int set, std::vector<float> *pos_samples);
+  void stratify_links(int set, int views, std::vector<float> *pos_start_points,
+      std::vector<float> *pos_end_points, std::vector<float> *pos_links);
+  inline int get_link_views(bool start_points, bool end_points,
+                            bool links) const {
+    return (start_points ? 1 : 0) | (end_points ? 2 : 0) | (links ? 4 : 0);
+  }
+  GLsizei get_lod_vertex_count(const std::vector<float> &pos,
+                               int nb_vertices_per_element) const;
   void compute_halfedge(const Mesh &mesh, halfedge_descriptor hd,
                         std::vector<float> *pos) const;
   void compute_vertex(const Mesh &mesh, vertex_descriptor vd,
@@ -569,6 +669,20 @@ class Scene : public QObject {
     const Minangle_remesher *remesher = m_minangle_remesh.get_remesher();
     return is_input ? remesher->get_input() : remesher->get_remesh();
   }
+  inline Mesh_properties* get_mesh_properties(bool is_input) {
+    Minangle_remesher *remesher = m_minangle_remesh.get_remesher();
+    return is_input ? remesher->get_input() : remesher->get_remesh();
+  }
+
+  // 3) background remeshing and loading
+  void run_in_worker(const std::function<void()> &command,
+      const std::function<void()> &on_finished = std::function<void()>());
+  void worker_loop();
+  bool report_progress();       // called by the remesher in the worker
+  void publish_preview();
+  Mesh* read_mesh(QString file_name);          // called in the worker
+  QString get_loading_message(int stage) const;
+  void finish_loading(QString file_name);
 
  private:
   // 1) general data
@@ -598,6 +712,10 @@ class Scene : public QObject {
     ka_Remesh_samples,
     ka_Remesh_normal_edges,
     ka_Remesh_special_edges,
+    ka_Input_indexed_faces,       // indexed plain faces and mesh edges
+    ka_Input_indexed_edges,
+    ka_Remesh_indexed_faces,
+    ka_Remesh_indexed_edges,
     ka_Face_in_start,             // face in links
     ka_Face_in_end,
     ka_Face_in_links,
@@ -633,6 +751,12 @@ class Scene : public QObject {
     kb_Remesh_sample_pos,
     kb_Remesh_normal_edge_pos,
     kb_Remesh_special_edge_pos,
+    kb_Input_vertex_pos,           // indexed plain faces and mesh edges
+    kb_Input_face_indices,
+    kb_Input_edge_indices,
+    kb_Remesh_vertex_pos,
+    kb_Remesh_face_indices,
+    kb_Remesh_edge_indices,
     kb_Face_in_start_points,       // face in links
     kb_Face_in_end_points,
     kb_Face_in_link_lines,
@@ -668,6 +792,22 @@ class Scene : public QObject {
   int mvpLocation_with_light;
   int fLocation_with_light;
   int colorLocation_with_light;
+  // 2.3) buffer capacities (in bytes) and what the next upload writes: the
+  // whole buffer if it is modified, otherwise the recorded byte ranges
+  int m_buffer_capacities[VBOs::kb_NbOfVbos];
+  bool m_is_buffer_modified[VBOs::kb_NbOfVbos];
+  std::vector<std::pair<std::size_t, std::size_t>>
+      m_buffer_ranges[VBOs::kb_NbOfVbos];
+  // 2.4) what the indexed buffers were built from, see
+  // compute_indexed_elements()
+  struct Indexed_state {
+    Indexed_state() : mesh_properties(NULL), has_faces(false),
+      has_edges(false) {}
+    const Mesh_properties *mesh_properties;   // NULL if not built
+    bool has_faces;
+    bool has_edges;
+  };
+  Indexed_state m_indexed_states[2];              // input, remesh
   
   // 3) rendering variables
   bool m_view_input;
@@ -708,6 +848,12 @@ class Scene : public QObject {
   std::vector<float> pos_remesh_samples;
   std::vector<float> pos_remesh_normal_edges;
   std::vector<float> pos_remesh_special_edges;
+  std::vector<float> pos_input_vertices;          // indexed input
+  std::vector<GLuint> idx_input_faces;
+  std::vector<GLuint> idx_input_edges;
+  std::vector<float> pos_remesh_vertices;         // indexed remesh
+  std::vector<GLuint> idx_remesh_faces;
+  std::vector<GLuint> idx_remesh_edges;
   std::vector<float> pos_face_in_start_points;   // face in links
   std::vector<float> pos_face_in_end_points;
   std::vector<float> pos_face_in_links;
@@ -727,8 +873,80 @@ class Scene : public QObject {
   std::vector<float> pos_vertex_out_end_points;
   std::vector<float> pos_vertex_out_links;
 
+  // 4) cached voronoi cells, indexed by the face index. A face is recomputed
+  // only if its signature (triangle, samples and colors) changed
+  struct Voronoi_cell_cache {
+    Voronoi_cell_cache() : valid(false), signature(0) {}
+    bool valid;
+    std::size_t signature;
+    std::vector<float> faces, face_normals, face_colors, boundaries;
+  };
+  mutable std::vector<Voronoi_cell_cache> m_input_voronoi_cells;
+  mutable std::vector<Voronoi_cell_cache> m_remesh_voronoi_cells;
+
+  // 5) background remeshing. The remesher is only accessed by the worker
+  // while m_worker_busy, the GUI draws the published previews meanwhile
+  std::thread m_worker;
+  std::mutex m_worker_mutex;
+  std::condition_variable m_worker_condition;
+  std::function<void()> m_worker_command;         // at most one, see busy
+  bool m_worker_stop;
+  std::atomic<bool> m_worker_busy;
+  std::atomic<bool> m_cancel_requested;
+  std::atomic<bool> m_operation_finished;
+  int m_preview_operation_count;
+  int m_preview_interval;                         // in milliseconds
+  int m_nb_unpublished_operations;                // worker only
+  std::chrono::steady_clock::time_point m_last_preview_time;
+  std::mutex m_preview_mutex;                     // guards the preview
+  std::atomic<bool> m_preview_ready;
+  std::vector<float> m_preview_vertices;
+  std::vector<GLuint> m_preview_faces;
+  std::vector<GLuint> m_preview_edges;
+  std::function<void()> m_on_operation_finished;  // GUI only
+  enum LoadingStage {
+    k_not_loading = 0,
+    k_reading,
+    k_preprocessing_input,
+    k_preprocessing_remesh,
+    k_nb_loading_stages = k_preprocessing_remesh
+  };
+  std::atomic<int> m_loading_stage;
+  int m_reported_loading_stage;                   // GUI only
+  std::atomic<std::size_t> m_loading_memory_estimate;   // in bytes
+  bool m_loading_succeeded;       // written by the worker before it finishes
+
+  // 6) level of detail. Samples and links are stored in a spatially
+  // stratified order, so that any prefix covers the whole mesh evenly
+  int m_lod_pixels_per_element;
+  std::size_t m_lod_budget;                       // elements per frame
+  // the orders are kept while the links are unchanged (see
+  // Minangle_remesher::get_links_generation()), as the stratified links
+  enum StratifiedSets {
+    ks_Input_samples,
+    ks_Remesh_samples,
+    ks_Face_in_links,           // same order as their VBOs
+    ks_Face_out_links,
+    ks_Edge_in_links,
+    ks_Edge_out_links,
+    ks_Vertex_in_links,
+    ks_Vertex_out_links,
+    ks_NbOfSets
+  };
+  struct Stratified_order {
+    Stratified_order() : generation(0), key(-1) {}
+    unsigned int generation;
+    int key;                    // draw options of the set, -1 if not computed
+    std::vector<std::size_t> order;
+  };
+  Stratified_order m_stratified_orders[ks_NbOfSets];
+
   const double TARGET_EDGE_LENGTH = 0.2;
   const int SMOOTH_ITERATION_COUNT = 3;
+  const int PREVIEW_OPERATION_COUNT = 1000;
+  const int PREVIEW_INTERVAL = 200;
+  const std::size_t BUFFER_RANGE_GAP = 4096;      // closer ranges are merged
+  const int LOD_PIXELS_PER_ELEMENT = 16;
 
 }; // end class Scene
 
@@ -0,0 +1,122 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Microbenchmark of the bounded Voronoi cells of CBvd: clipping by the
+// bisectors against the dual hull path of Polygon_kernel. Each triangle gets
+// random samples as in the face sampling, then the cell areas and centroids
+// are computed with both paths on the same triangulation.
+// usage: bench_bounded_cell [#triangles = 2000] [#samples = 30]
+
+// C/C++
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Real_timer.h>
+// boost
+#include <boost/random.hpp>
+// local
+#include "internal/minangle_remeshing/mesh_properties.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef CGAL::Polygon_mesh_processing::internal::Mesh_properties<Kernel>
+    Mesh_properties;
+typedef Mesh_properties::Bvd Bvd;
+typedef Mesh_properties::FT FT;
+typedef Mesh_properties::Point Point;
+typedef Mesh_properties::Triangle Triangle;
+
+int main(int argc, char *argv[]) {
+  int nb_triangles = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int nb_samples = argc > 2 ? std::atoi(argv[2]) : 30;
+  if (nb_triangles <= 0 || nb_samples <= 0) {
+    std::cerr << "usage: " << argv[0] << " [#triangles] [#samples]"
+      << std::endl;
+    return 1;
+  }
+  boost::random::mt19937 gen(1);
+  boost::random::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+  boost::random::uniform_real_distribution<double> parameter(0.0, 1.0);
+  CGAL::Real_timer clipping_timer, kernel_timer;
+  FT max_area_difference = 0.0, max_centroid_difference = 0.0;
+  for (int i = 0; i < nb_triangles; ++i) {
+    // 1) a random triangle and its samples
+    Point a(coordinate(gen), coordinate(gen), coordinate(gen));
+    Point b(coordinate(gen), coordinate(gen), coordinate(gen));
+    Point c(coordinate(gen), coordinate(gen), coordinate(gen));
+    Triangle triangle(a, b, c);
+    if (triangle.is_degenerate()) {
+      continue;
+    }
+    Bvd bvd(triangle);
+    for (int j = 0; j < nb_samples; ++j) {
+      FT u = parameter(gen), v = parameter(gen);
+      if (u + v > 1.0) {
+        u = 1.0 - u;
+        v = 1.0 - v;
+      }
+      bvd.add_point(a + (b - a) * u + (c - a) * v);
+    }
+    // 2) both paths on the same triangulation
+    std::vector<FT> clipped_areas, kernel_areas;
+    std::vector<Point> clipped_centroids, kernel_centroids;
+    clipping_timer.start();
+    bvd.get_cells_area(std::back_inserter(clipped_areas));
+    bvd.get_centroids(std::back_inserter(clipped_centroids));
+    clipping_timer.stop();
+    bvd.set_use_polygon_kernel(true);
+    kernel_timer.start();
+    bvd.get_cells_area(std::back_inserter(kernel_areas));
+    bvd.get_centroids(std::back_inserter(kernel_centroids));
+    kernel_timer.stop();
+    // 3) the paths must agree
+    if (clipped_areas.size() != kernel_areas.size() ||
+        clipped_centroids.size() != kernel_centroids.size()) {
+      std::cerr << "the paths returned different numbers of cells"
+        << std::endl;
+      return 1;
+    }
+    for (std::size_t j = 0; j < clipped_areas.size(); ++j) {
+      max_area_difference = CGAL::max(max_area_difference,
+        std::abs(clipped_areas[j] - kernel_areas[j]));
+    }
+    for (std::size_t j = 0; j < clipped_centroids.size(); ++j) {
+      max_centroid_difference = CGAL::max(max_centroid_difference,
+        CGAL::squared_distance(clipped_centroids[j], kernel_centroids[j]));
+    }
+  }
+  max_centroid_difference = std::sqrt(max_centroid_difference);
+  std::cout << "triangles: " << nb_triangles << ", samples per triangle: "
+    << nb_samples << std::endl;
+  std::cout << "  clipping      : " << clipping_timer.time() << " s"
+    << std::endl;
+  std::cout << "  Polygon_kernel: " << kernel_timer.time() << " s"
+    << std::endl;
+  std::cout << "  max area difference    : " << max_area_difference
+    << std::endl;
+  std::cout << "  max centroid difference: " << max_centroid_difference
+    << std::endl;
+  return max_area_difference < 1e-8 && max_centroid_difference < 1e-8 ?
+    0 : 1;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Microbenchmark of the per-face max error reduction: the old loop over the
+// std::list links against Squared_length_buffer, with its scalar and
+// dispatched (AVX2 if supported) reductions. As in the mesh properties, each
+// face owns a list of out links and a list of iterators to the in links of
+// other faces; the buffer timings include gathering the difference vectors.
+// usage: bench_max_error_reduction [#faces = 20000] [#links = 64]
+
+// C/C++
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <utility>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/squared_distance_3.h>
+#include <CGAL/Real_timer.h>
+// boost
+#include <boost/random.hpp>
+// local
+#include "internal/minangle_remeshing/triangle_distance.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef Kernel::Point_3 Point;
+typedef Kernel::Vector_3 Vector;
+typedef std::pair<Point, Point> Point_pair;
+typedef std::pair<double, Point_pair> Link;
+typedef std::list<Link> Link_list;
+typedef Link_list::const_iterator Link_list_const_iter;
+typedef std::list<Link_list_const_iter> Link_iter_list;
+typedef CGAL::Polygon_mesh_processing::internal::Triangle_batch Triangle_batch;
+typedef CGAL::Polygon_mesh_processing::internal::Squared_length_buffer
+    Squared_length_buffer;
+
+void add_link_vector(const Link &link, Squared_length_buffer *buffer) {
+  Vector v = link.second.second - link.second.first;
+  buffer->add(v.x(), v.y(), v.z());
+}
+
+int main(int argc, char *argv[]) {
+  int nb_faces = argc > 1 ? std::atoi(argv[1]) : 20000;
+  int nb_links = argc > 2 ? std::atoi(argv[2]) : 64;
+  if (nb_faces <= 0 || nb_links <= 1) {
+    std::cerr << "usage: " << argv[0] << " [#faces] [#links]" << std::endl;
+    return 1;
+  }
+  // 1) random links, half owned by the face and half owned by other faces
+  boost::random::mt19937 gen(1);
+  boost::random::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+  boost::random::uniform_int_distribution<int> face(0, nb_faces - 1);
+  int nb_out_links = nb_links / 2, nb_in_links = nb_links - nb_out_links;
+  std::vector<Link_list> out_links(nb_faces);
+  for (int i = 0; i < nb_faces; ++i) {
+    for (int j = 0; j < nb_out_links; ++j) {
+      Point p(coordinate(gen), coordinate(gen), coordinate(gen));
+      Point q(coordinate(gen), coordinate(gen), coordinate(gen));
+      out_links[i].push_back(Link(0.0, Point_pair(p, q)));
+    }
+  }
+  std::vector<Link_iter_list> in_links(nb_faces);
+  for (int i = 0; i < nb_faces; ++i) {
+    for (int j = 0; j < nb_in_links; ++j) {
+      const Link_list &links = out_links[face(gen)];
+      Link_list_const_iter it = links.begin();
+      std::advance(it, j % nb_out_links);
+      in_links[i].push_back(it);
+    }
+  }
+
+  // 2) the old path, link by link through the std::list iterators
+  std::vector<double> reference(nb_faces), scalar(nb_faces),
+    dispatched(nb_faces);
+  CGAL::Real_timer timer;
+  timer.start();
+  for (int i = 0; i < nb_faces; ++i) {
+    double max_se = 0.0;
+    for (Link_iter_list::const_iterator it = in_links[i].begin();
+      it != in_links[i].end(); ++it) {
+      const Link &link = **it;
+      max_se = CGAL::max(max_se,
+        CGAL::squared_distance(link.second.first, link.second.second));
+    }
+    for (Link_list_const_iter it = out_links[i].begin();
+      it != out_links[i].end(); ++it) {
+      const Link &link = *it;
+      max_se = CGAL::max(max_se,
+        CGAL::squared_distance(link.second.first, link.second.second));
+    }
+    reference[i] = max_se;
+  }
+  timer.stop();
+  double list_time = timer.time();
+
+  // 3) Squared_length_buffer, scalar and dispatched reductions
+  Squared_length_buffer buffer;
+  double reduction_time[2] = {0.0, 0.0};
+  std::vector<double> *values[2] = {&scalar, &dispatched};
+  for (int k = 0; k < 2; ++k) {
+    timer.reset();
+    timer.start();
+    for (int i = 0; i < nb_faces; ++i) {
+      buffer.clear();
+      for (Link_iter_list::const_iterator it = in_links[i].begin();
+        it != in_links[i].end(); ++it) {
+        add_link_vector(**it, &buffer);
+      }
+      for (Link_list_const_iter it = out_links[i].begin();
+        it != out_links[i].end(); ++it) {
+        add_link_vector(*it, &buffer);
+      }
+      (*values[k])[i] = k == 0 ? buffer.max_scalar(0) : buffer.max();
+    }
+    timer.stop();
+    reduction_time[k] = timer.time();
+  }
+
+  // 4) the paths must agree
+  double max_difference = 0.0;
+  for (int i = 0; i < nb_faces; ++i) {
+    max_difference = CGAL::max(max_difference,
+      std::abs(scalar[i] - reference[i]));
+    max_difference = CGAL::max(max_difference,
+      std::abs(dispatched[i] - reference[i]));
+  }
+  std::cout << "faces: " << nb_faces << ", links per face: " << nb_links
+    << ", avx2: " << (Triangle_batch::has_avx2() ? "yes" : "no") << std::endl;
+  std::cout << "  std::list links                  : " << list_time << " s"
+    << std::endl;
+  std::cout << "  Squared_length_buffer::max_scalar: " << reduction_time[0]
+    << " s" << std::endl;
+  std::cout << "  Squared_length_buffer::max       : " << reduction_time[1]
+    << " s" << std::endl;
+  std::cout << "  max difference                   : " << max_difference
+    << std::endl;
+  return max_difference < 1e-12 ? 0 : 1;
+}
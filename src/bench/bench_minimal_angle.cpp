@@ -0,0 +1,257 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Microbenchmark of the minimal angle and the small radian queue keys of
+// maximize_minimal_angle on a model: the acos-based radians used before
+// against the cosine-based path, which compares cosines and only takes acos
+// on the result or on the queued entries. Both paths must give the same
+// minimal angle and the same queue order.
+// usage: bench_minimal_angle <model.off> [min angle threshold = 30]
+//   [#rounds = 100]
+
+// C/C++
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Surface_mesh.h>
+#include <CGAL/squared_distance_3.h>
+#include <CGAL/Real_timer.h>
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef Kernel::Point_3 Point;
+typedef Kernel::Vector_3 Vector;
+typedef CGAL::Surface_mesh<Point> Mesh;
+typedef Mesh::Halfedge_index halfedge_descriptor;
+typedef std::pair<double, halfedge_descriptor> Queue_entry;
+
+const double MIN_VALUE = 0.0001;
+const double SQUARED_MIN_VALUE = 0.00000001;
+
+// the radian of the angle abc, as computed before the cosine path
+double calculate_radian(const Point &a, const Point &b, const Point &c) {
+  if (CGAL::squared_distance(a, b) < SQUARED_MIN_VALUE ||
+    CGAL::squared_distance(a, c) < SQUARED_MIN_VALUE ||
+    CGAL::squared_distance(b, c) < SQUARED_MIN_VALUE) {
+    return 0.0;   // degenerated case
+  }
+  Vector v1 = a - b;
+  double v1_length = std::sqrt(v1 * v1);
+  if (v1_length < MIN_VALUE) {
+    return 0.0;
+  }
+  v1 = v1 / v1_length;
+  Vector v2 = c - b;
+  double v2_length = std::sqrt(v2 * v2);
+  if (v2_length < MIN_VALUE) {
+    return 0.0;
+  }
+  v2 = v2 / v2_length;
+  double cos_value = v1 * v2;
+  if (cos_value > 1.0) {
+    cos_value = 1.0;
+  }
+  if (cos_value < -1.0) {
+    cos_value = -1.0;
+  }
+  return std::acos(cos_value);
+}
+
+// the cosine of the angle abc, as in Mesh_properties::calculate_cosine
+double calculate_cosine(const Point &a, const Point &b, const Point &c) {
+  Vector v1 = a - b;
+  Vector v2 = c - b;
+  double v1_sl = v1 * v1, v2_sl = v2 * v2;
+  if (v1_sl < SQUARED_MIN_VALUE || v2_sl < SQUARED_MIN_VALUE ||
+    CGAL::squared_distance(a, c) < SQUARED_MIN_VALUE) {
+    return 1.0;   // degenerated case (radian 0)
+  }
+  double cos_value = (v1 * v2) / std::sqrt(v1_sl * v2_sl);
+  if (cos_value > 1.0) {
+    cos_value = 1.0;
+  }
+  if (cos_value < -1.0) {
+    cos_value = -1.0;
+  }
+  return cos_value;
+}
+
+// the smallest angle is opposite to the shortest side
+double calculate_smallest_radian(
+    const Point &a, const Point &b, const Point &c) {
+  double ab = CGAL::squared_distance(a, b);
+  double ac = CGAL::squared_distance(a, c);
+  double bc = CGAL::squared_distance(b, c);
+  if (ab < ac) {
+    return ab < bc ? calculate_radian(b, c, a) : calculate_radian(c, a, b);
+  } else {
+    return ac < bc ? calculate_radian(a, b, c) : calculate_radian(c, a, b);
+  }
+}
+
+double calculate_largest_cosine(
+    const Point &a, const Point &b, const Point &c) {
+  double ab = CGAL::squared_distance(a, b);
+  double ac = CGAL::squared_distance(a, c);
+  double bc = CGAL::squared_distance(b, c);
+  if (ab < ac) {
+    return ab < bc ? calculate_cosine(b, c, a) : calculate_cosine(c, a, b);
+  } else {
+    return ac < bc ? calculate_cosine(a, b, c) : calculate_cosine(c, a, b);
+  }
+}
+
+bool smaller_key(const Queue_entry &a, const Queue_entry &b) {
+  return a.first < b.first;
+}
+
+int main(int argc, char *argv[]) {
+  double threshold = argc > 2 ? std::atof(argv[2]) : 30.0;
+  int nb_rounds = argc > 3 ? std::atoi(argv[3]) : 100;
+  std::ifstream in(argc > 1 ? argv[1] : "");
+  Mesh mesh;
+  if (argc < 2 || !(in >> mesh) || mesh.is_empty() || nb_rounds <= 0) {
+    std::cerr << "usage: " << argv[0]
+      << " <model.off> [min angle threshold] [#rounds]" << std::endl;
+    return 1;
+  }
+  // 1) the corners of each face, each halfedge with its opposite corner
+  std::vector<Point> corners;
+  std::vector<halfedge_descriptor> halfedges;
+  for (Mesh::Face_range::const_iterator fi = mesh.faces().begin();
+    fi != mesh.faces().end(); ++fi) {
+    halfedge_descriptor hd = mesh.halfedge(*fi);
+    for (int i = 0; i <= 2; ++i) {
+      // (target, opposite, source) as in calculate_opposite_radian
+      corners.push_back(mesh.point(mesh.target(hd)));
+      corners.push_back(mesh.point(mesh.target(mesh.next(hd))));
+      corners.push_back(mesh.point(mesh.source(hd)));
+      halfedges.push_back(hd);
+      hd = mesh.next(hd);
+    }
+  }
+  std::size_t nb_faces = halfedges.size() / 3;
+  double radian_threshold = threshold * CGAL_PI / 180.0;
+  double cosine_threshold = std::cos(radian_threshold);
+
+  // 2) the minimal radian, one acos per face against one acos in total
+  CGAL::Real_timer timer;
+  double radian_minimal = 0.0, cosine_minimal = 0.0;
+  timer.start();
+  for (int round = 0; round < nb_rounds; ++round) {
+    radian_minimal = CGAL_PI;
+    for (std::size_t i = 0; i < nb_faces; ++i) {
+      const Point *p = &corners[9 * i];
+      radian_minimal = CGAL::min(radian_minimal,
+        calculate_smallest_radian(p[0], p[1], p[2]));
+    }
+  }
+  timer.stop();
+  double radian_minimal_time = timer.time();
+  timer.reset();
+  timer.start();
+  for (int round = 0; round < nb_rounds; ++round) {
+    double largest_cosine = -1.0;
+    for (std::size_t i = 0; i < nb_faces; ++i) {
+      const Point *p = &corners[9 * i];
+      largest_cosine = CGAL::max(largest_cosine,
+        calculate_largest_cosine(p[0], p[1], p[2]));
+    }
+    cosine_minimal = std::acos(largest_cosine);
+  }
+  timer.stop();
+  double cosine_minimal_time = timer.time();
+
+  // 3) the small radian queue keys, filtered by radian or by cosine
+  std::vector<Queue_entry> radian_queue, cosine_queue;
+  timer.reset();
+  timer.start();
+  for (int round = 0; round < nb_rounds; ++round) {
+    radian_queue.clear();
+    for (std::size_t i = 0; i < halfedges.size(); ++i) {
+      const Point *p = &corners[3 * i];
+      double radian = calculate_radian(p[0], p[1], p[2]);
+      if (radian < radian_threshold) {
+        radian_queue.push_back(Queue_entry(radian, halfedges[i]));
+      }
+    }
+  }
+  timer.stop();
+  double radian_queue_time = timer.time();
+  timer.reset();
+  timer.start();
+  for (int round = 0; round < nb_rounds; ++round) {
+    cosine_queue.clear();
+    for (std::size_t i = 0; i < halfedges.size(); ++i) {
+      const Point *p = &corners[3 * i];
+      double cosine = calculate_cosine(p[0], p[1], p[2]);
+      if (cosine > cosine_threshold) {
+        cosine_queue.push_back(Queue_entry(std::acos(cosine), halfedges[i]));
+      }
+    }
+  }
+  timer.stop();
+  double cosine_queue_time = timer.time();
+
+  // 4) the paths must agree. The queue is a multiset on the key, so equal
+  // keys keep their insertion order. Near 0 the two keys may differ by the
+  // rounding of acos, so a swap is only accepted between keys that close.
+  const double tolerance = 1e-7;
+  std::stable_sort(radian_queue.begin(), radian_queue.end(), smaller_key);
+  std::stable_sort(cosine_queue.begin(), cosine_queue.end(), smaller_key);
+  int nb_misordered = 0;
+  double max_key_difference = 0.0;
+  if (radian_queue.size() != cosine_queue.size()) {
+    nb_misordered = -1;
+  } else {
+    for (std::size_t i = 0; i < radian_queue.size(); ++i) {
+      max_key_difference = CGAL::max(max_key_difference,
+        std::abs(radian_queue[i].first - cosine_queue[i].first));
+      if (radian_queue[i].second != cosine_queue[i].second &&
+        std::abs(radian_queue[i].first - cosine_queue[i].first) >
+        tolerance) {
+        ++nb_misordered;
+      }
+    }
+  }
+  double minimal_difference = std::abs(radian_minimal - cosine_minimal);
+  std::cout << "faces: " << nb_faces << ", rounds: " << nb_rounds
+    << ", min angle threshold: " << threshold << std::endl;
+  std::cout << "  minimal angle, acos : " << radian_minimal_time << " s"
+    << std::endl;
+  std::cout << "  minimal angle, cos  : " << cosine_minimal_time << " s"
+    << std::endl;
+  std::cout << "  queue keys, acos    : " << radian_queue_time << " s"
+    << std::endl;
+  std::cout << "  queue keys, cos     : " << cosine_queue_time << " s"
+    << std::endl;
+  std::cout << "  minimal angle       : " << radian_minimal * 180.0 / CGAL_PI
+    << " (difference " << minimal_difference << ")" << std::endl;
+  std::cout << "  queued halfedges    : " << radian_queue.size() << " / "
+    << cosine_queue.size() << ", misordered: " << nb_misordered
+    << ", max key difference: " << max_key_difference << std::endl;
+  return nb_misordered == 0 && minimal_difference < tolerance ? 0 : 1;
+}
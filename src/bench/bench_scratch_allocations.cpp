@@ -0,0 +1,160 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Allocations per local operation of the temporary containers, with the
+// std allocators, a process wide boost pool and Scratch_allocator. Each
+// operation replays the temporaries of a typical collapse: 10 one-ring
+// faces, 30 extended faces, 8 link halfedges, 260 in links and 260 end
+// points (the in link lists and the end points stay on std::allocator).
+// usage: bench_scratch_allocations [#operations = 20000] [#threads = 4]
+
+// C/C++
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Real_timer.h>
+// boost
+#include <boost/pool/pool_alloc.hpp>
+// local
+#include "Minangle_remesh.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef CGAL::Polygon_mesh_processing::internal::Minangle_remesher<Kernel>
+    Minangle_remesher;
+typedef Minangle_remesher::Point Point;
+typedef Minangle_remesher::Point_list Point_list;
+typedef Minangle_remesher::Link_list Link_list;
+typedef Minangle_remesher::Link_iter_list Link_iter_list;
+typedef Minangle_remesher::face_descriptor face_descriptor;
+typedef Minangle_remesher::halfedge_descriptor halfedge_descriptor;
+typedef CGAL::Polygon_mesh_processing::internal::Scratch_pool Scratch_pool;
+
+// every call of the global operator new is counted
+static std::atomic<unsigned long> nb_allocations(0);
+
+void* operator new(std::size_t size) {
+  ++nb_allocations;
+  void *p = std::malloc(size == 0 ? 1 : size);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+template <class Face_set, class Halfedge_list>
+void replay_operations(int nb_operations, Link_list *links) {
+  std::size_t sink = 0;
+  for (int op = 0; op < nb_operations; ++op) {
+    Face_set one_ring_faces, extended_faces, differ_faces;
+    for (int i = 0; i < 10; ++i) {
+      one_ring_faces.insert(face_descriptor((op + i * 7) % 1000));
+    }
+    for (int i = 0; i < 30; ++i) {
+      extended_faces.insert(face_descriptor((op + i * 3) % 1000));
+    }
+    std::set_difference(extended_faces.begin(), extended_faces.end(),
+      one_ring_faces.begin(), one_ring_faces.end(),
+      std::inserter(differ_faces, differ_faces.end()));
+    Halfedge_list halfedges;
+    for (int i = 0; i < 8; ++i) {
+      halfedges.push_back(halfedge_descriptor(i));
+    }
+    Link_iter_list in_links;
+    Point_list end_points;
+    for (auto it = links->begin(); it != links->end(); ++it) {
+      in_links.push_back(it);
+      end_points.push_back(Point(CGAL::ORIGIN));   // only the node counts
+    }
+    sink += differ_faces.size() + halfedges.size() + in_links.size() +
+      end_points.size();
+  }
+  if (sink == 1) {
+    std::cout << std::endl;
+  }
+}
+
+template <class Face_set, class Halfedge_list>
+void run(const char *name, int nb_operations, int nb_threads,
+    Link_list *links) {
+  // 1) one thread: allocations per operation
+  unsigned long before = nb_allocations;
+  CGAL::Real_timer timer;
+  timer.start();
+  replay_operations<Face_set, Halfedge_list>(nb_operations, links);
+  timer.stop();
+  double allocations = double(nb_allocations - before) / nb_operations;
+  double single_time = timer.time() / nb_operations * 1e6;
+  // 2) nb_threads threads at once, as the concurrent collapse simulations
+  timer.reset();
+  timer.start();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nb_threads; ++i) {
+    threads.push_back(std::thread(replay_operations<Face_set, Halfedge_list>,
+      nb_operations, links));
+  }
+  for (std::size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  timer.stop();
+  double parallel_time = timer.time() / nb_operations * 1e6;
+  std::cout << "  " << name << allocations << " allocations/op, "
+    << single_time << " us/op, " << parallel_time << " us/op with "
+    << nb_threads << " threads" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  int nb_operations = argc > 1 ? std::atoi(argv[1]) : 20000;
+  int nb_threads = argc > 2 ? std::atoi(argv[2]) : 4;
+  if (nb_operations <= 0 || nb_threads <= 0) {
+    std::cerr << "usage: " << argv[0] << " [#operations] [#threads]"
+      << std::endl;
+    return 1;
+  }
+  Link_list links(260);
+  std::cout << "operations: " << nb_operations << std::endl;
+  run<std::set<face_descriptor>, std::list<halfedge_descriptor>>(
+    "std::allocator      : ", nb_operations, nb_threads, &links);
+  run<std::set<face_descriptor, std::less<face_descriptor>,
+      boost::fast_pool_allocator<face_descriptor>>,
+    std::list<halfedge_descriptor,
+      boost::fast_pool_allocator<halfedge_descriptor>>>(
+    "fast_pool_allocator : ", nb_operations, nb_threads, &links);
+  run<Minangle_remesher::Face_set, Minangle_remesher::Halfedge_list>(
+    "Scratch_allocator   : ", nb_operations, nb_threads, &links);
+  std::size_t held = Scratch_pool::held();
+  Scratch_pool::purge();
+  std::cout << "  scratch nodes held: " << held << " bytes, "
+    << Scratch_pool::held() << " bytes after purge()" << std::endl;
+  return 0;
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Microbenchmark of Triangle_batch (one point against a batch of triangles,
+// as in the brute force link regeneration) against the scalar CGAL path.
+// usage: bench_triangle_distance [#triangles = 64] [#queries = 200000]
+
+// C/C++
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/squared_distance_3.h>
+#include <CGAL/Real_timer.h>
+// boost
+#include <boost/random.hpp>
+// local
+#include "internal/minangle_remeshing/triangle_distance.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef Kernel::Point_3 Point;
+typedef Kernel::Triangle_3 Triangle;
+typedef CGAL::Polygon_mesh_processing::internal::Triangle_batch Triangle_batch;
+
+int main(int argc, char *argv[]) {
+  int nb_triangles = argc > 1 ? std::atoi(argv[1]) : 64;
+  int nb_queries = argc > 2 ? std::atoi(argv[2]) : 200000;
+  if (nb_triangles <= 0 || nb_queries <= 0) {
+    std::cerr << "usage: " << argv[0] << " [#triangles] [#queries]"
+      << std::endl;
+    return 1;
+  }
+  // 1) random triangles and query points (queries also lie off the faces)
+  boost::random::mt19937 gen(1);
+  boost::random::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+  std::vector<Triangle> triangles;
+  Triangle_batch batch;
+  batch.reserve(nb_triangles);
+  for (int i = 0; i < nb_triangles; ++i) {
+    Point a(coordinate(gen), coordinate(gen), coordinate(gen));
+    Point b(coordinate(gen), coordinate(gen), coordinate(gen));
+    Point c(coordinate(gen), coordinate(gen), coordinate(gen));
+    triangles.push_back(Triangle(a, b, c));
+    batch.add(a.x(), a.y(), a.z(), b.x(), b.y(), b.z(), c.x(), c.y(), c.z());
+  }
+  std::vector<Point> queries;
+  queries.reserve(nb_queries);
+  for (int i = 0; i < nb_queries; ++i) {
+    queries.push_back(Point(2.0 * coordinate(gen), 2.0 * coordinate(gen),
+      2.0 * coordinate(gen)));
+  }
+
+  // 2) CGAL::squared_distance, one triangle at a time
+  std::vector<double> reference(nb_queries), scalar(nb_queries),
+    dispatched(nb_queries);
+  CGAL::Real_timer timer;
+  timer.start();
+  for (int i = 0; i < nb_queries; ++i) {
+    double min_sd = std::numeric_limits<double>::max();
+    for (int j = 0; j < nb_triangles; ++j) {
+      min_sd = CGAL::min(min_sd, CGAL::squared_distance(queries[i],
+        triangles[j]));
+    }
+    reference[i] = min_sd;
+  }
+  timer.stop();
+  double cgal_time = timer.time();
+
+  // 3) Triangle_batch, scalar and dispatched (AVX2 if supported) paths
+  double x = 0.0, y = 0.0, z = 0.0;
+  timer.reset();
+  timer.start();
+  for (int i = 0; i < nb_queries; ++i) {
+    const Point &p = queries[i];
+    batch.closest_scalar(p.x(), p.y(), p.z(), &x, &y, &z, &scalar[i]);
+  }
+  timer.stop();
+  double scalar_time = timer.time();
+  timer.reset();
+  timer.start();
+  for (int i = 0; i < nb_queries; ++i) {
+    const Point &p = queries[i];
+    batch.closest(p.x(), p.y(), p.z(), &x, &y, &z, &dispatched[i]);
+  }
+  timer.stop();
+  double dispatched_time = timer.time();
+
+  // 4) the paths must agree
+  double max_difference = 0.0;
+  for (int i = 0; i < nb_queries; ++i) {
+    max_difference = CGAL::max(max_difference,
+      std::abs(scalar[i] - reference[i]));
+    max_difference = CGAL::max(max_difference,
+      std::abs(dispatched[i] - reference[i]));
+  }
+  std::cout << "triangles: " << nb_triangles << ", queries: " << nb_queries
+    << ", avx2: " << (Triangle_batch::has_avx2() ? "yes" : "no") << std::endl;
+  std::cout << "  CGAL::squared_distance        : " << cgal_time << " s"
+    << std::endl;
+  std::cout << "  Triangle_batch::closest_scalar: " << scalar_time << " s"
+    << std::endl;
+  std::cout << "  Triangle_batch::closest       : " << dispatched_time << " s"
+    << std::endl;
+  std::cout << "  max difference                : " << max_difference
+    << std::endl;
+  return max_difference < 1e-9 ? 0 : 1;
+}
@@ -42,6 +42,7 @@ public:
   // circulators
   typedef typename Dt::Edge_circulator Edge_circulator;
   typedef typename Dt::Face_circulator Face_circulator;
+  typedef typename Dt::Vertex_circulator Vertex_circulator;
   //containers
   typedef typename std::list<Point_3> Point_list;
   typedef typename Point_list::iterator Point_iter;
@@ -54,12 +55,13 @@ public:
   using Dt::is_infinite;
   using Dt::dual;
   using Dt::incident_faces;
+  using Dt::incident_vertices;
   using Dt::circumcenter;
 public:
   //
   // life cyle
   //
-  CBvd(const Triangle_3& triangle) {
+  CBvd(const Triangle_3& triangle) : m_use_polygon_kernel(false) {
     m_triangle_3d = triangle;
     m_to_3d = compute_transformation(m_triangle_3d.supporting_plane(),
       m_triangle_3d.vertex(0));
@@ -112,6 +114,10 @@ public:
     Dt::insert(q);
   }
 
+  // computes the bounded cells with Polygon_kernel instead of clipping
+  // (the reference path of bench/bench_bounded_cell)
+  void set_use_polygon_kernel(bool value) { m_use_polygon_kernel = value; }
+
   template <class OutputIterator> // value_type = Point_3
   bool get_centroids(OutputIterator out) const {
     if (Dt::dimension() < 2)
@@ -277,6 +283,56 @@ private:
 
   template <class OutputIterator>
   bool compute_bounded_cell(Vertex_handle v, OutputIterator out) const {
+    // clip the (ccw) domain by the bisector of v and each Delaunay neighbor,
+    // ping-ponging between two stack buffers (Sutherland-Hodgman)
+    if (m_use_polygon_kernel)
+      return compute_bounded_cell_by_kernel(v, out);
+    Point_2 buffers[2][MAX_CELL_SIZE];
+    Point_2 *polygon = buffers[0];
+    Point_2 *clipped = buffers[1];
+    bool ccw = m_triangle_2d.orientation() == CGAL::COUNTERCLOCKWISE;
+    for (int i = 0; i < 3; i++)
+      polygon[i] = m_triangle_2d[ccw ? i : 2 - i];
+    int size = 3;
+    Vertex_circulator u = incident_vertices(v);
+    Vertex_circulator end = u;
+    CGAL_For_all(u, end) {
+      if (is_infinite(u)) continue;
+      size = clip_by_bisector(polygon, size, v->point(), u->point(), clipped);
+      if (size < 0) // too many cell vertices for the buffers
+        return compute_bounded_cell_by_kernel(v, out);
+      std::swap(polygon, clipped);
+      if (size == 0) break;
+    }
+    for (int i = 0; i < size; i++)
+      *out++ = polygon[i];
+    return size >= 3;
+  }
+
+  int clip_by_bisector(const Point_2 *polygon, int size, const Point_2& p,
+    const Point_2& q, Point_2 *clipped) const {
+    // keeps the part of polygon closer to p than to q,
+    // returns its size or -1 if it does not fit in MAX_CELL_SIZE
+    Vector_2 normal = q - p;
+    Point_2 midpoint = CGAL::midpoint(p, q);
+    int nb = 0;
+    for (int i = 0; i < size; i++) {
+      const Point_2& a = polygon[i];
+      const Point_2& b = polygon[(i + 1) % size];
+      FT fa = (a - midpoint) * normal;
+      FT fb = (b - midpoint) * normal;
+      if (nb + 2 > MAX_CELL_SIZE) return -1;
+      if (fa <= 0.0)
+        clipped[nb++] = a;
+      if ((fa < 0.0 && fb > 0.0) || (fa > 0.0 && fb < 0.0))
+        clipped[nb++] = a + (b - a) * (fa / (fa - fb));
+    }
+    return nb;
+  }
+
+  template <class OutputIterator>
+  bool compute_bounded_cell_by_kernel(Vertex_handle v,
+    OutputIterator out) const {
     std::list<Segment_2> segments;
     Edge_circulator edge = incident_edges(v);
     Edge_circulator end = edge;
@@ -578,10 +634,12 @@ private:
   }
 
 private:
+  enum { MAX_CELL_SIZE = 64 };  // buffer size of the clipped cells
   Triangle_2 m_triangle_2d;
   Triangle_3 m_triangle_3d;
   Aff_transform_3 m_to_2d;
   Aff_transform_3 m_to_3d;
+  bool m_use_polygon_kernel;
 };
 
 #endif // CGAL_BVD_H
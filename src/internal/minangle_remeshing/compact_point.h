@@ -0,0 +1,60 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+#ifndef SRC_INTERNAL_MINANGLE_REMESHING_COMPACT_POINT_H_
+#define SRC_INTERNAL_MINANGLE_REMESHING_COMPACT_POINT_H_
+
+// CGAL
+#include <CGAL/number_utils.h>
+
+namespace CGAL {
+namespace Polygon_mesh_processing {
+namespace internal {
+
+// Point stored as three float32 offsets from an origin chosen by the owner
+// of the points (the center of the input bounding box, see
+// Mesh_properties::set_link_origin()). The origin is not stored, so the
+// conversions from and to the kernel point take it explicitly; the links are
+// stored in half the space while all the computations stay in double
+// precision. Changing the origin invalidates the stored points.
+template <class Point>
+class Compact_point {
+ public:
+  Compact_point() : x_(0.0f), y_(0.0f), z_(0.0f) {}
+
+  Compact_point(const Point &p, const Point &origin)
+    : x_(static_cast<float>(CGAL::to_double(p.x() - origin.x()))),
+      y_(static_cast<float>(CGAL::to_double(p.y() - origin.y()))),
+      z_(static_cast<float>(CGAL::to_double(p.z() - origin.z()))) {}
+
+  Point to_point(const Point &origin) const {
+    return Point(origin.x() + x_, origin.y() + y_, origin.z() + z_);
+  }
+
+ private:
+  float x_, y_, z_;
+};
+
+}   // namespace internal
+}   // namespace Polygon_mesh_processing
+}   // namespace CGAL
+
+#endif  // SRC_INTERNAL_MINANGLE_REMESHING_COMPACT_POINT_H_
@@ -23,6 +23,7 @@
 #define SRC_INTERNAL_MINANGLE_REMESHING_MESH_PROPERTIES_H_
 
 // C/C++
+#include <cmath>
 #include <limits>
 #include <functional>
 #include <string>
@@ -32,22 +33,34 @@
 #include <set>
 #include <utility>
 #include <algorithm>
+#include <iterator>
 #include <fstream>
 // CGAL
 #include <CGAL/Timer.h>
 #include <CGAL/Triangulation_hierarchy_2.h>
 #include <CGAL/Surface_mesh.h>
-#include <CGAL/Polygon_mesh_processing/polygon_soup_to_polygon_mesh.h>
 #include <CGAL/AABB_tree.h>
 #include <CGAL/AABB_traits.h>
 #include <CGAL/AABB_face_graph_triangle_primitive.h>
 #include <CGAL/Polygon_mesh_processing/compute_normal.h>
+#include <CGAL/hilbert_sort.h>
+#include <CGAL/Spatial_sort_traits_adapter_3.h>
+// tbb
+#ifdef CGAL_LINKED_WITH_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#endif
 // boost
 #include <boost/bimap.hpp>
 #include <boost/bimap/multiset_of.hpp>
+#include <boost/property_map/property_map.hpp>
 #include <boost/random.hpp>
 // local
 #include "Bvd.h"
+#include "triangle_distance.h"
+#include "compact_point.h"
+#include "scratch_allocator.h"
 
 // namespace definition
 namespace PMP = CGAL::Polygon_mesh_processing;
@@ -59,6 +72,7 @@ const double DOUBLE_MIN = -1000000.0;
 const int MAX_VALUE = 10000;
 const double MIN_VALUE = 0.0001;  // specified for numerical stability
 const double SQUARED_MIN_VALUE = 0.00000001;
+const double COS_MIN_VALUE = std::cos(MIN_VALUE);  // radian < MIN_VALUE
 
 // numerical types
 enum SampleNumberStrategy {
@@ -70,7 +84,8 @@ enum SampleNumberStrategy {
 
 enum SampleStrategy {
   k_uniform = 0,  // #samples per face is proportional to its area
-  k_adaptive      // #samples per face is roughly the same
+  k_adaptive,     // #samples per face is roughly the same
+  k_error_driven  // k_adaptive scaled by the feature intensity and max error
 };
 
 enum OptimizeType {
@@ -119,12 +134,17 @@ struct NamedParameters {
   bool verbose_progress;
   bool apply_initial_mesh_simplification;
   bool apply_final_vertex_relocation;
+  bool use_face_geometry_cache;
+  int collapse_batch_size;
+  bool reorder_elements;
+  double max_garbage_ratio;
   // sample parameters
   int samples_per_face_in;
   int samples_per_face_out;
   int max_samples_per_area;
   int min_samples_per_triangle;
   int bvd_iteration_count;
+  int sampling_thread_count;
   SampleNumberStrategy sample_number_strategy;
   SampleStrategy sample_strategy;
   bool use_stratified_sampling;
@@ -180,8 +200,14 @@ class Mesh_properties {
   typedef typename Bvd::Color_list Color_list;
   typedef typename Bvd::Color_iter Color_iter;
   typedef typename Bvd::Color_const_iter Color_const_iter;
-  // Local link related
-  typedef std::pair<Point, Point> Point_pair;        // for out links
+  // Local link related (-DCGAL_MINANGLE_COMPACT_LINKS stores the link end
+  // points in float32, see compact_point.h)
+#ifdef CGAL_MINANGLE_COMPACT_LINKS
+  typedef Compact_point<Point> Link_point;
+#else
+  typedef Point Link_point;
+#endif
+  typedef std::pair<Link_point, Link_point> Point_pair;   // for out links
   typedef std::pair<FT, Point_pair> Link;
   typedef std::list<Link> Link_list;
   typedef typename Link_list::iterator Link_list_iter;
@@ -190,8 +216,8 @@ class Mesh_properties {
   typedef typename Link_iter_list::iterator Link_iter_list_iter;
   typedef typename Link_iter_list::const_iterator Link_iter_list_const_iter;
   typedef std::list<Link*> Link_pointer_list;
-  typedef typename std::list<Link*>::iterator Link_pointer_iter;
-  typedef typename std::list<Link*>::const_iterator Link_pointer_const_iter;
+  typedef typename Link_pointer_list::iterator Link_pointer_iter;
+  typedef typename Link_pointer_list::const_iterator Link_pointer_const_iter;
   // Surface_mesh related
   typedef CGAL::Surface_mesh<Point> Mesh;
   typedef typename boost::graph_traits<Mesh>::halfedge_descriptor
@@ -206,24 +232,34 @@ class Mesh_properties {
                          Halfedge_around_face_circulator;
   typedef CGAL::Face_around_target_circulator<Mesh>
                          Face_around_target_circulator;
-  // Element list
-  typedef std::list<halfedge_descriptor> Halfedge_list;
-  typedef typename std::list<halfedge_descriptor>::iterator Halfedge_iter;
-  typedef typename std::list<halfedge_descriptor>::const_iterator
-                                                   Halfedge_const_iter;
-  typedef std::list<edge_descriptor> Edge_list;
-  typedef typename std::list<edge_descriptor>::iterator Edge_iter;
-  typedef typename std::list<edge_descriptor>::const_iterator Edge_const_iter;
-  typedef std::list<vertex_descriptor> Vertex_list;
-  typedef typename std::list<vertex_descriptor>::iterator Vertex_iter;
-  typedef typename std::list<vertex_descriptor>::const_iterator
-                                                 Vertex_const_iter;
-  typedef std::list<face_descriptor> Face_list;
-  typedef typename std::list<face_descriptor>::iterator Face_iter;
-  typedef typename std::list<face_descriptor>::const_iterator Face_const_iter;
+  // Element list (the temporary containers of the local operations recycle
+  // their nodes through Scratch_pool, see scratch_allocator.h)
+  typedef std::list<halfedge_descriptor,
+      Scratch_allocator<halfedge_descriptor>> Halfedge_list;
+  typedef typename Halfedge_list::iterator Halfedge_iter;
+  typedef typename Halfedge_list::const_iterator Halfedge_const_iter;
+  typedef std::list<edge_descriptor,
+      Scratch_allocator<edge_descriptor>> Edge_list;
+  typedef typename Edge_list::iterator Edge_iter;
+  typedef typename Edge_list::const_iterator Edge_const_iter;
+  typedef std::list<vertex_descriptor,
+      Scratch_allocator<vertex_descriptor>> Vertex_list;
+  typedef typename Vertex_list::iterator Vertex_iter;
+  typedef typename Vertex_list::const_iterator Vertex_const_iter;
+  typedef std::list<face_descriptor,
+      Scratch_allocator<face_descriptor>> Face_list;
+  typedef typename Face_list::iterator Face_iter;
+  typedef typename Face_list::const_iterator Face_const_iter;
+  // Element set
+  typedef std::set<vertex_descriptor, std::less<vertex_descriptor>,
+      Scratch_allocator<vertex_descriptor>> Vertex_set;
+  typedef std::set<face_descriptor, std::less<face_descriptor>,
+      Scratch_allocator<face_descriptor>> Face_set;
   // Property related
   typedef typename boost::property_map<Mesh,
       CGAL::dynamic_face_property_t<int>>::type Face_tags;         // faces
+  typedef typename boost::property_map<Mesh,
+      CGAL::dynamic_face_property_t<unsigned int>>::type Face_epochs;
   typedef typename boost::property_map<Mesh,
       CGAL::dynamic_face_property_t<Normal>>::type Face_normals;
   typedef typename boost::property_map<Mesh,
@@ -246,6 +282,8 @@ class Mesh_properties {
       CGAL::dynamic_halfedge_property_t<Link_list>>::type Halfedge_link_list;
   typedef typename boost::property_map<Mesh,
       CGAL::dynamic_vertex_property_t<int>>::type Vertex_tags;     // vertices
+  typedef typename boost::property_map<Mesh,
+      CGAL::dynamic_vertex_property_t<unsigned int>>::type Vertex_epochs;
   typedef typename boost::property_map<Mesh,
       CGAL::dynamic_vertex_property_t<FT>>::type Vertex_max_dihedral;
   typedef typename boost::property_map<Mesh,
@@ -289,13 +327,50 @@ class Mesh_properties {
       }
     }
   };
+  struct Memory_item {      // one container of the memory report
+    Memory_item(const std::string &n, std::size_t c, std::size_t b)
+      : name(n), count(c), bytes(b) {}
+    std::string name;
+    std::size_t count;      // elements, slots or links stored
+    std::size_t bytes;
+  };
+  typedef std::vector<Memory_item> Memory_report;
+  struct Face_geometry {    // cached geometry of a face
+    Face_geometry()
+      : valid(false), area(0.0), largest_cosine(1.0), quality(0.0) {}
+    bool valid;
+    FT area;
+    FT largest_cosine;
+    FT quality;
+    halfedge_descriptor longest_hd;
+    halfedge_descriptor shortest_hd;
+  };
+  typedef typename boost::property_map<Mesh,
+      CGAL::dynamic_face_property_t<Face_geometry>>::type Face_geometries;
+  struct Link_journal {     // undo log of the links rebuilt by a relocation
+    vertex_descriptor vd;
+    std::vector<std::pair<face_descriptor, Link_list>> face_out_links;
+    std::vector<std::pair<halfedge_descriptor, Link_list>> edge_out_links;
+    Link vertex_out_link;
+    std::vector<face_descriptor> in_link_faces;
+    std::vector<Link_iter_list> face_in_links, edge_in_links;
+    std::vector<Link_pointer_list> vertex_in_links;
+    std::vector<FT> max_squared_errors;
+    std::vector<std::pair<Link*, Link_point>> in_link_end_points;
+  };
 
  public:
   // 1) life cycles
   explicit Mesh_properties(Mesh *mesh)
-    : mesh_(*mesh) {
+    : mesh_(*mesh), use_face_geometry_cache_(false), visit_epoch_(0),
+      max_squared_error_threshold_(0.0), max_squared_errors_measured_(false),
+      link_origin_(CGAL::ORIGIN), all_elements_modified_(true) {
     // face related properties
     face_tags_ = get(CGAL::dynamic_face_property_t<int>(), mesh_);
+    face_visit_epochs_ =
+        get(CGAL::dynamic_face_property_t<unsigned int>(), mesh_);
+    face_geometries_ =
+        get(CGAL::dynamic_face_property_t<Face_geometry>(), mesh_);
     face_normals_ = get(CGAL::dynamic_face_property_t<Normal>(), mesh_);
     face_max_squared_errors_ = get(CGAL::dynamic_face_property_t<FT>(), mesh_);
     face_out_links_ = get(CGAL::dynamic_face_property_t<Link_list>(), mesh_);
@@ -323,6 +398,8 @@ class Mesh_properties {
     }
     // vertex related properties
     vertex_tags_ = get(CGAL::dynamic_vertex_property_t<int>(), mesh_);
+    vertex_visit_epochs_ =
+        get(CGAL::dynamic_vertex_property_t<unsigned int>(), mesh_);
     vertex_max_dihedrals_ = get(CGAL::dynamic_vertex_property_t<FT>(), mesh_);
     vertex_gaussian_curvatures_ =
         get(CGAL::dynamic_vertex_property_t<FT>(), mesh_);
@@ -373,6 +450,32 @@ class Mesh_properties {
   }
 
   // 3) properties access
+  bool get_use_face_geometry_cache() const { return use_face_geometry_cache_; }
+  void set_use_face_geometry_cache(bool value) {
+    if (value != use_face_geometry_cache_) {
+      use_face_geometry_cache_ = value;
+      invalidate_face_geometries();
+    }
+  }
+  FT get_max_squared_error_threshold() const
+      { return max_squared_error_threshold_; }
+  void set_max_squared_error_threshold(FT value)
+      { max_squared_error_threshold_ = value; }
+  bool get_max_squared_errors_measured() const
+      { return max_squared_errors_measured_; }
+  // the origin of the compact link end points, shared by the meshes whose
+  // links point to each other; changing it invalidates the links
+  const Point& get_link_origin() const { return link_origin_; }
+  void set_link_origin(const Point &value) { link_origin_ = value; }
+#ifdef CGAL_MINANGLE_COMPACT_LINKS
+  Point to_point(const Link_point &p) const
+      { return p.to_point(link_origin_); }
+  Link_point to_link_point(const Point &p) const
+      { return Link_point(p, link_origin_); }
+#else
+  const Point& to_point(const Link_point &p) const { return p; }
+  const Link_point& to_link_point(const Point &p) const { return p; }
+#endif
   int& get_face_tag(face_descriptor fd) { return get(face_tags_, fd); }
   const int& get_face_tag(face_descriptor fd) const
       { return get(face_tags_, fd); }
@@ -392,6 +495,47 @@ class Mesh_properties {
       { return get(face_max_squared_errors_, fd); }
   void set_face_max_squared_error(face_descriptor fd, FT value)
       { put(face_max_squared_errors_, fd, value); }
+  void invalidate_face_geometry(face_descriptor fd)
+      { get(face_geometries_, fd).valid = false; }
+  void invalidate_face_geometries(vertex_descriptor vd) {
+    Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
+    do {
+      if (!is_border(*hb)) {
+        invalidate_face_geometry(get_face(*hb));
+      }
+      ++hb;
+    } while (hb != he);
+  }
+  void set_vertex_point(vertex_descriptor vd, const Point &value) {
+    // moves vd and drops the cached geometries of its faces; apart from
+    // split_long_edge(), every vertex move goes through here
+    get_point(vd) = value;
+    invalidate_face_geometries(vd);
+    mark_one_ring_modified(vd);
+  }
+  void invalidate_face_geometries() {
+    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
+        fi != mesh_.faces().end(); ++fi) {
+      invalidate_face_geometry(*fi);
+    }
+  }
+
+  // elements (possibly removed) modified by the local operations since the
+  // last clear_modified_elements(), for the incremental updates of a viewer.
+  // If all_elements_modified() the lists are empty and everything changed
+  bool all_elements_modified() const { return all_elements_modified_; }
+  const std::vector<face_descriptor>& get_modified_faces() const
+      { return modified_faces_; }
+  const std::vector<edge_descriptor>& get_modified_edges() const
+      { return modified_edges_; }
+  const std::vector<vertex_descriptor>& get_modified_vertices() const
+      { return modified_vertices_; }
+  void clear_modified_elements() {
+    all_elements_modified_ = false;
+    modified_faces_.clear();
+    modified_edges_.clear();
+    modified_vertices_.clear();
+  }
 
   Link_list& get_face_out_links(face_descriptor fd)
       { return get(face_out_links_, fd); }
@@ -483,26 +627,20 @@ class Mesh_properties {
     const NamedParameters &np) const {
     // step 1: fill the large error queue if necessary
     if (np.decrease_max_errors) {
-      FT max_se_threshold = std::pow(max_error_threshold_value, 2);
-      halfedge_descriptor max_error_halfedge;
-      for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-        fi != mesh_.faces().end(); ++fi) {
-        FT max_se = get_face_max_squared_error(*fi);
-        if (max_se >= max_se_threshold) {
-          max_error_halfedge = get_longest_halfedge(*fi);
-          large_error_queue->insert(Halfedge_long(max_error_halfedge, max_se));
-        }
-      }
+      fill_large_error_queue(max_error_threshold_value, large_error_queue);
     }
     // step 2: fill the collapse_candidate queue
-    for (typename Mesh::Halfedge_range::const_iterator hi = mesh_.halfedges().begin();
-      hi != mesh_.halfedges().end(); ++hi) {
-      if (!is_border(*hi)) {
-        FT len = length(*hi);
-        FT radian = calculate_opposite_radian(*hi);
-        collapse_candidate_queue->insert(Halfedge_short(*hi, len * radian));
+    std::vector<halfedge_descriptor> halfedges(mesh_.halfedges().begin(),
+      mesh_.halfedges().end());
+    fill_queue_in_bulk(halfedges, [this](halfedge_descriptor hd,
+      halfedge_descriptor *key, FT *priority) {
+      if (is_border(hd)) {
+        return false;
       }
-    }
+      *key = hd;
+      *priority = length(hd) * calculate_opposite_radian(hd);
+      return true;
+    }, collapse_candidate_queue);
   }
 
   void fill_small_radian_edges(FT max_error_threshold_value,
@@ -511,42 +649,42 @@ class Mesh_properties {
     const NamedParameters &np) const {
     // step 1: fill the large error queue if necessary
     if (np.decrease_max_errors) {
-      FT max_se_threshold = std::pow(max_error_threshold_value, 2);
-      halfedge_descriptor max_error_halfedge;
-      for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-        fi != mesh_.faces().end(); ++fi) {
-        FT max_se = get_face_max_squared_error(*fi);
-        if (max_se >= max_se_threshold) {
-          max_error_halfedge = get_longest_halfedge(*fi);
-          large_error_queue->insert(Halfedge_long(max_error_halfedge, max_se));
-        }
+      fill_large_error_queue(max_error_threshold_value, large_error_queue);
+    }
+    // step 2: fill the small radian queue (filter in cosine space)
+    FT cosine_threshold = std::cos(to_radian(np.min_angle_threshold));
+    std::vector<halfedge_descriptor> halfedges(mesh_.halfedges().begin(),
+      mesh_.halfedges().end());
+    fill_queue_in_bulk(halfedges, [this, cosine_threshold](
+      halfedge_descriptor hd, halfedge_descriptor *key, FT *priority) {
+      if (is_border(hd)) {
+        return false;
       }
-    }
-    // step 2: fill the small radian queue
-    FT min_radian_threshold = to_radian(np.min_angle_threshold);
-    for (typename Mesh::Halfedge_range::const_iterator hi = mesh_.halfedges().begin();
-      hi != mesh_.halfedges().end(); ++hi) {
-      if (!is_border(*hi)) {
-        FT radian = calculate_opposite_radian(*hi);
-        if (radian < min_radian_threshold) {
-          small_radian_queue->insert(Halfedge_short(*hi, radian));
-        }
+      FT cosine = calculate_opposite_cosine(hd);
+      if (cosine <= cosine_threshold) {
+        return false;
       }
-    }
+      *key = hd;
+      *priority = std::acos(cosine);
+      return true;
+    }, small_radian_queue);
   }
 
   void fill_relocate_candidate_vertices(
     DPQueue_vertex_short *relocate_candidate_queue) const {
-    for (typename Mesh::Vertex_range::const_iterator vi = mesh_.vertices().begin();
-      vi != mesh_.vertices().end(); ++vi) {
-      FT min_radian = calculate_minimal_radian_incident_to_vertex(*vi);
-      relocate_candidate_queue->insert(Vertex_short(*vi, min_radian));
-    }
+    std::vector<vertex_descriptor> vertices(mesh_.vertices().begin(),
+      mesh_.vertices().end());
+    fill_queue_in_bulk(vertices, [this](vertex_descriptor vd,
+      vertex_descriptor *key, FT *priority) {
+      *key = vd;
+      *priority = calculate_minimal_radian_incident_to_vertex(vd);
+      return true;
+    }, relocate_candidate_queue);
   }
 
   void update_relocate_candidate_vertices(vertex_descriptor vd,
     DPQueue_vertex_short *relocate_candidate_queue) const {
-    std::set<vertex_descriptor> incident_vertices;
+    Vertex_set incident_vertices;
     collect_incident_vertices(vd, &incident_vertices);
     incident_vertices.insert(vd);
     for (auto it = incident_vertices.begin();
@@ -693,7 +831,7 @@ class Mesh_properties {
     timer.reset();
     std::cout << "Generating face " << type << " links...";
     generate_face_links(face_tree, mesh_properties, bvd_iteration_count_value,
-      np.use_stratified_sampling, faces);
+      np.use_stratified_sampling, faces, np.sampling_thread_count);
     std::cout << "Done, count: " << get_face_out_link_count()
       << " (" << timer.time() << " s)" << std::endl;
     // reset tags
@@ -704,7 +842,7 @@ class Mesh_properties {
     bool reset_normal_dihedral, const Link_iter_list &face_in_links,
     const Link_iter_list &edge_in_links,
     const Link_pointer_list &vertex_in_links, vertex_descriptor vd,
-    const std::set<face_descriptor> &in_link_faces,
+    const Face_set &in_link_faces,
     const NamedParameters &np) {
     // step 1: update the local feature_intensity around vd
     update_local_feature_intensity(vd, reset_normal_dihedral, np);
@@ -728,22 +866,22 @@ class Mesh_properties {
     for (lit = face_in_links.begin(), pit = face_in_end_points.begin();
       lit != face_in_links.end(); ++lit, ++pit) {
       Link_list_iter it = *lit;
-      it->second.second = *pit;
+      it->second.second = to_link_point(*pit);
     }
     for (lit = edge_in_links.begin(), pit = edge_in_end_points.begin();
       lit != edge_in_links.end(); ++lit, ++pit) {
       Link_list_iter it = *lit;
-      it->second.second = *pit;
+      it->second.second = to_link_point(*pit);
     }
     for (link_iter = vertex_in_links.begin(),
       pit = vertex_in_end_points.begin(); link_iter != vertex_in_links.end();
       ++link_iter, ++pit) {
       Link *link = *link_iter;
-      link->second.second = *pit;
+      link->second.second = to_link_point(*pit);
     }
   }
 
-  void backup_local_in_links(const std::set<face_descriptor> &extended_faces,
+  void backup_local_in_links(const Face_set &extended_faces,
     Link_iter_list *face_in_links, Point_list *face_in_end_points,
     Link_iter_list *edge_in_links, Point_list *edge_in_end_points,
     Link_pointer_list *vertex_in_links,
@@ -755,17 +893,17 @@ class Mesh_properties {
     for (Link_iter_list_const_iter it = face_in_links->begin();
       it != face_in_links->end(); ++it) {
       Link_list_const_iter llit = *it;
-      face_in_end_points->push_back(llit->second.second);
+      face_in_end_points->push_back(to_point(llit->second.second));
     }
     for (Link_iter_list_const_iter it = edge_in_links->begin();
       it != edge_in_links->end(); ++it) {
       Link_list_const_iter llit = *it;
-      edge_in_end_points->push_back(llit->second.second);
+      edge_in_end_points->push_back(to_point(llit->second.second));
     }
     for (Link_pointer_const_iter it = vertex_in_links->begin();
       it != vertex_in_links->end(); ++it) {
       const Link* link = *it;
-      vertex_in_end_points->push_back(link->second.second);
+      vertex_in_end_points->push_back(to_point(link->second.second));
     }
   }
 
@@ -802,24 +940,65 @@ class Mesh_properties {
   }
 
   // 7) face collections
-  void collect_all_faces(std::set<face_descriptor> *faces) const {
+  void collect_all_faces(Face_set *faces) const {
     for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
       fi != mesh_.faces().end(); ++fi) {
       faces->insert(*fi);
     }
   }
 
-  void extend_faces(const std::set<face_descriptor> &one_ring_faces,
-    int stencil_ring_size, std::set<face_descriptor> *extended_faces) const {
+  void extend_faces(const Face_set &one_ring_faces,
+    int stencil_ring_size, Face_set *extended_faces) const {
+    std::vector<face_descriptor> faces;
+    extend_faces(one_ring_faces, stencil_ring_size, &faces);
+    std::sort(faces.begin(), faces.end());   // sorted, so inserted in O(1)
+    extended_faces->clear();
+    extended_faces->insert(faces.begin(), faces.end());
+  }
+
+  void extend_faces(const Face_set &one_ring_faces,
+    int stencil_ring_size, std::vector<face_descriptor> *extended_faces) const {
+    // breadth first traversal ring by ring; visited faces and vertices are
+    // stamped with the current epoch instead of being looked up in sets.
+    // Not reentrant: the stamps are shared by all traversals of mesh_
+    unsigned int epoch = next_visit_epoch();
     extended_faces->clear();
-    extended_faces->insert(one_ring_faces.begin(), one_ring_faces.end());
+    for (auto it = one_ring_faces.begin(); it != one_ring_faces.end(); ++it) {
+      put(face_visit_epochs_, *it, epoch);
+      extended_faces->push_back(*it);
+    }
+    size_t ring_begin = 0;
     for (int i = 0; i < stencil_ring_size; ++i) {
-      extend_faces_by_one_ring(extended_faces);
+      size_t ring_end = extended_faces->size();
+      for (size_t j = ring_begin; j < ring_end; ++j) {
+        halfedge_descriptor hd = mesh_.halfedge((*extended_faces)[j]);
+        halfedge_descriptor h = hd;
+        do {
+          vertex_descriptor vd = get_target_vertex(h);
+          if (get(vertex_visit_epochs_, vd) != epoch) {
+            put(vertex_visit_epochs_, vd, epoch);
+            Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_),
+              he(hb);
+            do {
+              if (!is_border(*hb)) {
+                face_descriptor fd = get_face(*hb);
+                if (get(face_visit_epochs_, fd) != epoch) {
+                  put(face_visit_epochs_, fd, epoch);
+                  extended_faces->push_back(fd);
+                }
+              }
+              ++hb;
+            } while (hb != he);
+          }
+          h = mesh_.next(h);
+        } while (h != hd);
+      }
+      ring_begin = ring_end;
     }
   }
 
   void collect_one_ring_faces_incident_to_edge(halfedge_descriptor hd,
-    std::set<face_descriptor> *faces) const {
+    Face_set *faces) const {
     vertex_descriptor vp = get_source_vertex(hd);
     vertex_descriptor vq = get_target_vertex(hd);
     collect_one_ring_faces_incident_to_vertex(vp, faces);
@@ -829,81 +1008,41 @@ class Mesh_properties {
   // 8) max errors
   void calculate_max_squared_errors() {
     // precondition: mesh_ has been sampled
-    reset_face_max_squared_errors(-1.0);
-    update_edge_in_max_squared_errors();
-    update_edge_out_max_squared_errors();
-    update_vertex_in_max_squared_errors();
-    update_vertex_out_max_squared_errors();
-  }
-
-  void calculate_max_squared_errors(std::set<face_descriptor> *faces) {
+    std::vector<face_descriptor> faces(mesh_.faces().begin(),
+      mesh_.faces().end());
+#ifdef CGAL_LINKED_WITH_TBB
+    // each face only writes its own error, so the faces are independent
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, faces.size()),
+      [&](const tbb::blocked_range<std::size_t> &range) {
+      Squared_length_buffer buffer;
+      for (std::size_t i = range.begin(); i != range.end(); ++i) {
+        set_face_max_squared_error(faces[i],
+          calculate_face_max_squared_error(faces[i], &buffer));
+      }
+    });
+#else
+    Squared_length_buffer buffer;
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+      set_face_max_squared_error(faces[i],
+        calculate_face_max_squared_error(faces[i], &buffer));
+    }
+#endif
+    max_squared_errors_measured_ = true;
+  }
+
+  void calculate_max_squared_errors(Face_set *faces) {
     // precondition: mesh_ has been sampled
+    Squared_length_buffer buffer;
     for (auto it = faces->begin(); it != faces->end(); ++it) {
-      FT max_se = 0.0, se = 0.0;
-      face_descriptor fd = *it;
-      // face in links
-      const Link_iter_list &face_in_links = get_face_in_links(fd);
-      for (Link_iter_list_const_iter it = face_in_links.begin();
-        it != face_in_links.end(); ++it) {
-        Link_list_const_iter llit = *it;
-        const Link &link = *llit;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(max_se, se);
-      }
-      // edge in links
-      const Link_iter_list &edge_in_links = get_edge_in_links(fd);
-      for (Link_iter_list_const_iter it = edge_in_links.begin();
-        it != edge_in_links.end(); ++it) {
-        Link_list_const_iter llit = *it;
-        const Link &link = *llit;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(max_se, se);
-      }
-      // vertex in links
-      const Link_pointer_list &vertex_in_links = get_vertex_in_links(fd);
-      for (Link_pointer_const_iter it = vertex_in_links.begin();
-        it != vertex_in_links.end(); ++it) {
-        const Link *link = *it;
-        se = CGAL::squared_distance(link->second.first, link->second.second);
-        max_se = CGAL::max(max_se, se);
-      }
-      // face out links
-      const Link_list &face_out_links = get_face_out_links(fd);
-      for (Link_list_const_iter it = face_out_links.begin();
-        it != face_out_links.end(); ++it) {
-        const Link &link = *it;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(max_se, se);
-      }
-      halfedge_descriptor hd = mesh_.halfedge(fd);
-      for (int i = 0; i <= 2; ++i) {
-        // edge out links
-        halfedge_descriptor hi = hd;
-        if (get_halfedge_normal_dihedral(hi) == -1.0) {
-          hi = get_opposite(hi);
-        }
-        const Link_list &edge_out_links = get_halfedge_out_links(hi);
-        for (Link_list_const_iter it = edge_out_links.begin();
-          it != edge_out_links.end(); ++it) {
-          const Link &link = *it;
-          se = CGAL::squared_distance(link.second.first, link.second.second);
-          max_se = CGAL::max(max_se, se);
-        }
-        // vervex out links
-        vertex_descriptor v = mesh_.target(hd);
-        const Link &link = get_vertex_out_link(v);
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(max_se, se);
-        hd = mesh_.next(hd);
-      }
-      set_face_max_squared_error(fd, max_se);
+      set_face_max_squared_error(*it,
+        calculate_face_max_squared_error(*it, &buffer));
     }
   }
 
   halfedge_descriptor calculate_local_maximal_error(
-    const std::set<face_descriptor> &faces, FT *max_error) const {
+    const Face_set &faces, FT *max_error) const {
     assert(!faces.empty());
-    typename std::set<face_descriptor>::const_iterator cit = faces.cbegin();
+    typename Face_set::const_iterator cit = faces.cbegin();
     face_descriptor max_error_fd = *cit;
     FT max_se = get_face_max_squared_error(max_error_fd), se = 0.0;
     ++cit;
@@ -944,8 +1083,10 @@ class Mesh_properties {
   }
 
   FT area(face_descriptor fd) const {
-    FT smallest_radian = calculate_smallest_radian(fd);
-    if (smallest_radian < MIN_VALUE) {
+    if (use_face_geometry_cache_) {
+      return get_face_geometry(fd).area;
+    }
+    if (calculate_largest_cosine(fd) > COS_MIN_VALUE) {
       return 0.0;
     } else {
       return CGAL::sqrt(triangle(fd).squared_area());
@@ -961,6 +1102,9 @@ class Mesh_properties {
   }
 
   halfedge_descriptor get_longest_halfedge(face_descriptor fd) const {
+    if (use_face_geometry_cache_) {
+      return get_face_geometry(fd).longest_hd;
+    }
     halfedge_descriptor hd = mesh_.halfedge(fd);
     halfedge_descriptor longest_hd = hd;
     FT longest_sl = squared_length(longest_hd);
@@ -976,6 +1120,46 @@ class Mesh_properties {
     return longest_hd;
   }
 
+  const Face_geometry& get_face_geometry(face_descriptor fd) const {
+    // computes the area, angles and extreme halfedges of fd in one pass, and
+    // keeps them until one of the local operators invalidates the face
+    Face_geometry &geometry = get(face_geometries_, fd);
+    if (geometry.valid) {
+      return geometry;
+    }
+    halfedge_descriptor hd = mesh_.halfedge(fd);
+    halfedge_descriptor hds[3] = { hd, mesh_.next(hd), mesh_.prev(hd) };
+    FT sls[3] = { squared_length(hds[0]), squared_length(hds[1]),
+      squared_length(hds[2]) };
+    int longest = 0, shortest = 0;
+    for (int i = 1; i < 3; ++i) {
+      if (sls[i] > sls[longest]) {
+        longest = i;
+      }
+      if (sls[i] < sls[shortest]) {
+        shortest = i;
+      }
+    }
+    geometry.longest_hd = hds[longest];
+    geometry.shortest_hd = hds[shortest];
+    geometry.largest_cosine = calculate_opposite_cosine(hds[shortest]);
+    if (geometry.largest_cosine > COS_MIN_VALUE) {
+      geometry.area = 0.0;
+    } else {
+      geometry.area = CGAL::sqrt(triangle(fd).squared_area());
+    }
+    FT h_t = CGAL::sqrt(sls[longest]);
+    FT p_t = (CGAL::sqrt(sls[0]) + CGAL::sqrt(sls[1]) +
+      CGAL::sqrt(sls[2])) / 2.0;
+    if (h_t <= 0.0) {   // invalid case
+      geometry.quality = 0.0;
+    } else {
+      geometry.quality = 6.0 * geometry.area / (CGAL::sqrt(3.0) * p_t * h_t);
+    }
+    geometry.valid = true;
+    return geometry;
+  }
+
   FT squared_length(halfedge_descriptor hd) const {
     const Point &a = get_point(get_source_vertex(hd));
     const Point &b = get_point(get_target_vertex(hd));
@@ -1034,17 +1218,18 @@ class Mesh_properties {
   }
 
   FT calculate_minimal_radian_around_vertex(vertex_descriptor vd) const {
-    FT minimal_radian = CGAL_PI;
+    // compare in cosine space, only the result is converted to radian
+    FT largest_cosine = -1.0;
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
       if (!is_border(*hb)) {
         face_descriptor fd = get_face(*hb);
-        FT radian = calculate_smallest_radian(fd);
-        minimal_radian = CGAL::min(minimal_radian, radian);
+        largest_cosine = CGAL::max(largest_cosine,
+          calculate_largest_cosine(fd));
       }
       ++hb;
     } while (hb != he);
-    return minimal_radian;
+    return std::acos(largest_cosine);
   }
 
   // 10) surface mesh properties
@@ -1105,18 +1290,121 @@ class Mesh_properties {
     }
   }
 
+  void calculate_local_feature_intensities(const Mesh_properties &source,
+    const std::vector<vertex_descriptor> &source_vertices,
+    vertex_descriptor vd, const NamedParameters &np) {
+    /* for a local mesh built by construct_local_mesh: only the edges of the
+    faces around vd and the vertices of these faces changed, everything else
+    is copied from source (source_vertices maps the local vertex indices to
+    the vertices of source, with a null vertex for vd) */
+    const Mesh &source_mesh = source.get_mesh();
+    // step 1: copy the edge feature intensities
+    for (typename Mesh::Edge_range::const_iterator ei = mesh_.edges().begin();
+      ei != mesh_.edges().end(); ++ei) {
+      halfedge_descriptor hd = mesh_.halfedge(*ei);
+      vertex_descriptor u = source_vertices[size_t(get_source_vertex(hd))];
+      vertex_descriptor v = source_vertices[size_t(get_target_vertex(hd))];
+      if (u == get_null_vertex() || v == get_null_vertex()) {
+        continue;   // incident to vd, calculated in step 3
+      }
+      std::pair<halfedge_descriptor, bool> source_hd =
+        CGAL::halfedge(u, v, source_mesh);
+      if (!source_hd.second) {
+        continue;
+      }
+      halfedge_descriptor owner = hd, source_owner = source_hd.first;
+      if (source.get_halfedge_normal_dihedral(source_owner) == -1.0) {
+        owner = get_opposite(owner);
+        source_owner = source_mesh.opposite(source_owner);
+      }
+      if (is_border(owner)) {   // the border of the local mesh
+        owner = get_opposite(owner);
+      }
+      set_halfedge_normal_dihedral(owner,
+        source.get_halfedge_normal_dihedral(source_owner));
+      set_halfedge_is_crease(owner, source.get_halfedge_is_crease(source_owner));
+      set_halfedge_normal_dihedral(get_opposite(owner), -1.0);
+      set_halfedge_is_crease(get_opposite(owner), false);
+    }
+    // step 2: copy the vertex feature intensities
+    for (typename Mesh::Vertex_range::const_iterator vi =
+      mesh_.vertices().begin(); vi != mesh_.vertices().end(); ++vi) {
+      vertex_descriptor v = source_vertices[size_t(*vi)];
+      if (v != get_null_vertex()) {
+        set_vertex_gaussian_curvature(*vi,
+          source.get_vertex_gaussian_curvature(v));
+        set_vertex_max_dihedral(*vi, source.get_vertex_max_dihedral(v));
+      }
+    }
+    // step 3: calculate the edges and vertices of the faces around vd
+    Vertex_list affected_vertices;
+    affected_vertices.push_back(vd);
+    Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
+    do {
+      calculate_edge_feature_intensity(mesh_.edge(*hb), false, np);
+      if (!is_border(*hb)) {    // the edge opposite to vd
+        calculate_edge_feature_intensity(mesh_.edge(mesh_.prev(*hb)), false,
+          np);
+      }
+      affected_vertices.push_back(get_source_vertex(*hb));
+      ++hb;
+    } while (hb != he);
+    for (Vertex_const_iter cit = affected_vertices.begin();
+      cit != affected_vertices.end(); ++cit) {
+      calculate_vertex_feature_intensity(*cit, np);
+    }
+    // step 4: update the crease edges around the affected vertices
+    if (np.inherit_element_types) {
+      for (Vertex_const_iter cit = affected_vertices.begin();
+        cit != affected_vertices.end(); ++cit) {
+        Halfedge_list effective_edges;
+        collect_effective_edges_in_one_ring(np.feature_control_delta, *cit,
+                                            &effective_edges);
+        if (effective_edges.size() == 2) {
+          for (auto it = effective_edges.begin();
+            it != effective_edges.end(); ++it) {
+            halfedge_descriptor hd = *it;
+            if (get_halfedge_normal_dihedral(hd) == -1.0) {
+              hd = get_opposite(hd);
+            }
+            set_halfedge_is_crease(hd, true);
+          }
+        }
+      }
+    }
+  }
+
+  void inherit_max_squared_errors(const Mesh_properties &source,
+    const Face_set &source_faces, vertex_descriptor vd) {
+    // for a local mesh built by construct_local_mesh: the faces around vd
+    // replace source_faces of source and inherit their largest error, so
+    // that SampleStrategy::k_error_driven samples them as in source
+    FT max_se = 0.0;
+    for (auto it = source_faces.begin(); it != source_faces.end(); ++it) {
+      max_se = CGAL::max(max_se, source.get_face_max_squared_error(*it));
+    }
+    Face_list faces;
+    collect_faces_incident_to_vertex(vd, &faces);
+    for (auto it = faces.begin(); it != faces.end(); ++it) {
+      set_face_max_squared_error(*it, max_se);
+    }
+    max_squared_error_threshold_ = source.max_squared_error_threshold_;
+    max_squared_errors_measured_ = source.max_squared_errors_measured_;
+  }
+
   halfedge_descriptor calculate_minimal_radian(FT *minimal_radian) const {
     // calculate the minimal radian of the mesh
-    *minimal_radian = CGAL_PI;
+    FT largest_cosine = -1.0;
     halfedge_descriptor minimal_radian_hd;
     for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
       fi != mesh_.faces().end(); ++fi) {
-      FT radian = calculate_smallest_radian(*fi);
-      if (radian < *minimal_radian) {
-        *minimal_radian = radian;
+      FT cosine = calculate_largest_cosine(*fi);
+      if (cosine > largest_cosine) {
+        largest_cosine = cosine;
         minimal_radian_hd = get_shortest_halfedge(*fi);
       }
     }
+    *minimal_radian = std::acos(largest_cosine);
     return minimal_radian_hd;
   }
 
@@ -1247,11 +1535,276 @@ class Mesh_properties {
       << min_out_link_count << std::endl;
   }
 
+  FT calculate_garbage_ratio() const {
+    std::size_t nb_removed = mesh_.number_of_removed_faces();
+    std::size_t nb_faces = mesh_.number_of_faces() + nb_removed;
+    return nb_faces == 0 ? 0.0 : static_cast<FT>(nb_removed) / nb_faces;
+  }
+
+  void collect_garbage(DPQueue_halfedge_long *large_error_queue,
+    DPQueue_halfedge_short *small_value_queue) {
+    // the dynamic properties are compacted with their elements, so the queued
+    // priorities (all non-negative) are parked in two temporary halfedge
+    // properties and the queues are re-read after the renumbering
+    typedef typename boost::property_map<Mesh,
+        CGAL::dynamic_halfedge_property_t<FT>>::type Halfedge_priorities;
+    Halfedge_priorities large_values =
+        get(CGAL::dynamic_halfedge_property_t<FT>(), mesh_);
+    Halfedge_priorities small_values =
+        get(CGAL::dynamic_halfedge_property_t<FT>(), mesh_);
+    for (typename Mesh::Halfedge_range::const_iterator hi =
+      mesh_.halfedges().begin(); hi != mesh_.halfedges().end(); ++hi) {
+      put(large_values, *hi, -1.0);
+      put(small_values, *hi, -1.0);
+    }
+    for (auto it = large_error_queue->left.begin();
+      it != large_error_queue->left.end(); ++it) {
+      put(large_values, it->first, it->second);
+    }
+    for (auto it = small_value_queue->left.begin();
+      it != small_value_queue->left.end(); ++it) {
+      put(small_values, it->first, it->second);
+    }
+    large_error_queue->clear();
+    small_value_queue->clear();
+    mesh_.collect_garbage();
+    invalidate_face_geometries();   // the cached halfedges were renumbered
+    mark_all_elements_modified();
+    for (typename Mesh::Halfedge_range::const_iterator hi =
+      mesh_.halfedges().begin(); hi != mesh_.halfedges().end(); ++hi) {
+      if (get(large_values, *hi) >= 0.0) {
+        large_error_queue->left.insert(large_error_queue->left.end(),
+          typename DPQueue_halfedge_long::left_value_type(
+          *hi, get(large_values, *hi)));
+      }
+      if (get(small_values, *hi) >= 0.0) {
+        small_value_queue->left.insert(small_value_queue->left.end(),
+          typename DPQueue_halfedge_short::left_value_type(
+          *hi, get(small_values, *hi)));
+      }
+    }
+  }
+
+  void calculate_memory_usage(const std::string &prefix,
+                              Memory_report *report) const {
+    // the payload of each container, the allocator overhead is not included.
+    // Property maps have one slot per element, removed ones included
+    std::size_t nb_vertices = mesh_.num_vertices();
+    std::size_t nb_halfedges = mesh_.num_halfedges();
+    std::size_t nb_faces = mesh_.num_faces();
+    // step 1: the surface mesh (points, connectivity and removed flags)
+    report->push_back(Memory_item(prefix + " surface mesh", nb_vertices,
+      calculate_surface_mesh_memory(nb_vertices, nb_halfedges, nb_faces)));
+    // step 2: the dynamic property maps, one item per map
+    calculate_property_memory(prefix, nb_vertices, nb_halfedges, nb_faces,
+      report);
+    // step 3: the link containers (list nodes)
+    std::size_t nb_face_out_links = 0, nb_edge_out_links = 0;
+    std::size_t nb_face_in_links = 0, nb_edge_in_links = 0;
+    std::size_t nb_vertex_in_links = 0;
+    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
+        fi != mesh_.faces().end(); ++fi) {
+      nb_face_out_links += get_face_out_links(*fi).size();
+      nb_face_in_links += get_face_in_links(*fi).size();
+      nb_edge_in_links += get_edge_in_links(*fi).size();
+      nb_vertex_in_links += get_vertex_in_links(*fi).size();
+    }
+    for (typename Mesh::Halfedge_range::const_iterator hi =
+        mesh_.halfedges().begin(); hi != mesh_.halfedges().end(); ++hi) {
+      nb_edge_out_links += get_halfedge_out_links(*hi).size();
+    }
+    const std::size_t node_links = 2 * sizeof(void*);
+    report->push_back(Memory_item(prefix + " face out links",
+      nb_face_out_links, nb_face_out_links * (sizeof(Link) + node_links)));
+    report->push_back(Memory_item(prefix + " edge out links",
+      nb_edge_out_links, nb_edge_out_links * (sizeof(Link) + node_links)));
+    report->push_back(Memory_item(prefix + " face in links",
+      nb_face_in_links,
+      nb_face_in_links * (sizeof(Link_list_iter) + node_links)));
+    report->push_back(Memory_item(prefix + " edge in links",
+      nb_edge_in_links,
+      nb_edge_in_links * (sizeof(Link_list_iter) + node_links)));
+    report->push_back(Memory_item(prefix + " vertex in links",
+      nb_vertex_in_links, nb_vertex_in_links * (sizeof(Link*) + node_links)));
+  }
+
+  static std::size_t estimate_memory_usage(const Mesh &mesh) {
+    // the mesh and the property maps allocated by the constructor, before
+    // the samples and links are generated
+    std::size_t nb_vertices = mesh.number_of_vertices();
+    std::size_t nb_halfedges = mesh.number_of_halfedges();
+    std::size_t nb_faces = mesh.number_of_faces();
+    Memory_report report;
+    calculate_property_memory("", nb_vertices, nb_halfedges, nb_faces,
+      &report);
+    std::size_t bytes = calculate_surface_mesh_memory(nb_vertices,
+      nb_halfedges, nb_faces);
+    for (std::size_t i = 0; i < report.size(); ++i) {
+      bytes += report[i].bytes;
+    }
+    return bytes;
+  }
+
+  static std::size_t calculate_surface_mesh_memory(std::size_t nb_vertices,
+      std::size_t nb_halfedges, std::size_t nb_faces) {
+    // a point and a halfedge per vertex, 4 indices per halfedge, a halfedge
+    // per face and the removed flags (one bit per vertex, edge and face)
+    typedef typename Mesh::size_type size_type;
+    return nb_vertices * (sizeof(Point) + sizeof(size_type)) +
+      nb_halfedges * 4 * sizeof(size_type) + nb_faces * sizeof(size_type) +
+      (nb_vertices + nb_halfedges / 2 + nb_faces) / 8;
+  }
+
+  template <typename Property_map>
+  static std::size_t get_value_size() {
+    return sizeof(typename boost::property_traits<Property_map>::value_type);
+  }
+
+  template <typename Property_map>
+  static void add_property_memory(const std::string &name,
+      std::size_t nb_slots, Memory_report *report) {
+    report->push_back(Memory_item(name, nb_slots,
+      nb_slots * get_value_size<Property_map>()));
+  }
+
+  static void calculate_property_memory(const std::string &prefix,
+      std::size_t nb_vertices, std::size_t nb_halfedges,
+      std::size_t nb_faces, Memory_report *report) {
+    // the only list of the dynamic property maps (one slot per element)
+    add_property_memory<Face_tags>(prefix + " face tags", nb_faces, report);
+    add_property_memory<Face_epochs>(prefix + " face visit epochs", nb_faces,
+      report);
+    add_property_memory<Face_geometries>(prefix + " face geometries",
+      nb_faces, report);
+    add_property_memory<Face_normals>(prefix + " face normals", nb_faces,
+      report);
+    add_property_memory<Face_max_errors>(prefix + " face max errors",
+      nb_faces, report);
+    add_property_memory<Face_link_list>(prefix + " face out link lists",
+      nb_faces, report);
+    add_property_memory<Face_link_iter_list>(prefix + " face in link lists",
+      nb_faces, report);
+    add_property_memory<Face_link_iter_list>(prefix + " edge in link lists",
+      nb_faces, report);
+    add_property_memory<Face_link_pointer_list>(
+      prefix + " vertex in link lists", nb_faces, report);
+    add_property_memory<Halfedge_tags>(prefix + " halfedge tags",
+      nb_halfedges, report);
+    add_property_memory<Halfedge_normal_dihedrals>(
+      prefix + " halfedge normal dihedrals", nb_halfedges, report);
+    add_property_memory<Halfedge_are_creases>(prefix + " halfedge creases",
+      nb_halfedges, report);
+    add_property_memory<Halfedge_link_list>(
+      prefix + " halfedge out link lists", nb_halfedges, report);
+    add_property_memory<Vertex_tags>(prefix + " vertex tags", nb_vertices,
+      report);
+    add_property_memory<Vertex_epochs>(prefix + " vertex visit epochs",
+      nb_vertices, report);
+    add_property_memory<Vertex_max_dihedral>(prefix + " vertex max dihedrals",
+      nb_vertices, report);
+    add_property_memory<Vertex_gaussian_curvature>(
+      prefix + " vertex gaussian curvatures", nb_vertices, report);
+    add_property_memory<Vertex_link>(prefix + " vertex out links",
+      nb_vertices, report);
+  }
+
+  static std::size_t calculate_face_tree_memory(const Face_tree &face_tree) {
+    // primitives, nodes (one bbox and two children each) and the search
+    // tree built by accelerate_distance_queries()
+    std::size_t nb_primitives = face_tree.size();
+    return nb_primitives * (sizeof(typename Face_tree::Primitive) +
+      sizeof(CGAL::Bbox_3) + 2 * sizeof(void*) +
+      sizeof(Point_and_primitive_id));
+  }
+
+  static std::size_t calculate_queue_entry_memory() {
+    // one value and two red-black tree hooks (3 pointers and a color each)
+    return sizeof(Halfedge_long) + 2 * 4 * sizeof(void*);
+  }
+
   // 13) static utilities
   static inline FT to_radian(FT angle) { return angle * CGAL_PI / 180.0; }
 
   static inline FT to_angle(FT radian) { return radian * 180.0 / CGAL_PI; }
 
+  static bool reorder_along_hilbert_curve(Mesh *mesh) {
+    // rebuilds mesh compactly with its vertices sorted along a Hilbert curve
+    // and its faces sorted by their first vertex on the curve, so that
+    // one-ring traversals touch nearby memory. The point and "h:crease" maps
+    // are transferred; mesh is left untouched if a face cannot be re-added
+    typedef CGAL::Spatial_sort_traits_adapter_3<Kernel,
+        typename Mesh::template Property_map<vertex_descriptor, Point>>
+        Sort_traits;
+    std::vector<vertex_descriptor> vertices(mesh->vertices().begin(),
+      mesh->vertices().end());
+    CGAL::hilbert_sort(vertices.begin(), vertices.end(),
+      Sort_traits(mesh->points()));
+    // step 1: add the vertices in curve order
+    Mesh reordered;
+    reordered.reserve(mesh->number_of_vertices(), mesh->number_of_edges(),
+      mesh->number_of_faces());
+    std::vector<vertex_descriptor> new_vertices(mesh->num_vertices());
+    std::vector<std::size_t> ranks(mesh->num_vertices());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+      new_vertices[vertices[i]] = reordered.add_vertex(mesh->point(vertices[i]));
+      ranks[vertices[i]] = i;
+    }
+    // step 2: add the faces ordered by their smallest vertex rank
+    std::vector<std::pair<std::size_t, face_descriptor>> faces;
+    faces.reserve(mesh->number_of_faces());
+    for (typename Mesh::Face_range::const_iterator fi = mesh->faces().begin();
+      fi != mesh->faces().end(); ++fi) {
+      std::size_t rank = ranks.size();
+      CGAL::Vertex_around_face_circulator<Mesh>
+          vb(mesh->halfedge(*fi), *mesh), ve(vb);
+      do {
+        rank = CGAL::min(rank, ranks[*vb]);
+        ++vb;
+      } while (vb != ve);
+      faces.push_back(std::make_pair(rank, *fi));
+    }
+    std::stable_sort(faces.begin(), faces.end(),
+      [](const std::pair<std::size_t, face_descriptor> &a,
+         const std::pair<std::size_t, face_descriptor> &b) {
+      return a.first < b.first;
+    });
+    std::vector<vertex_descriptor> face_vertices;
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+      face_vertices.clear();
+      CGAL::Vertex_around_face_circulator<Mesh>
+          vb(mesh->halfedge(faces[i].second), *mesh), ve(vb);
+      do {
+        face_vertices.push_back(new_vertices[*vb]);
+        ++vb;
+      } while (vb != ve);
+      if (reordered.add_face(face_vertices) == Mesh::null_face()) {
+        std::cout << "Reordering failed: the mesh is kept as is" << std::endl;
+        return false;
+      }
+    }
+    // step 3: transfer the crease edges
+    typename Mesh::template Property_map<halfedge_descriptor, bool>
+        halfedge_are_creases, new_halfedge_are_creases;
+    bool found = false;
+    boost::tie(halfedge_are_creases, found) =
+        mesh->template property_map<halfedge_descriptor, bool>("h:crease");
+    if (found) {
+      new_halfedge_are_creases = reordered.template
+          add_property_map<halfedge_descriptor, bool>("h:crease", false).first;
+      for (typename Mesh::Halfedge_range::const_iterator hi =
+        mesh->halfedges().begin(); hi != mesh->halfedges().end(); ++hi) {
+        if (halfedge_are_creases[*hi]) {
+          halfedge_descriptor hd = CGAL::halfedge(
+            new_vertices[mesh->source(*hi)], new_vertices[mesh->target(*hi)],
+            reordered).first;
+          new_halfedge_are_creases[hd] = true;
+        }
+      }
+    }
+    *mesh = reordered;
+    return true;
+  }
+
   // 14) input operations
   int eliminate_degenerated_faces() {
     FT radian_threshold = MIN_VALUE;
@@ -1339,7 +1892,7 @@ class Mesh_properties {
     const NamedParameters &np) {
     // max_error > 0 means to reduce error; othewiese improve radian
     // step 1: backup the original in_links and the edge types
-    std::set<face_descriptor> one_ring_faces, extended_faces;
+    Face_set one_ring_faces, extended_faces;
     one_ring_faces.insert(get_face(hd));
     if (!is_border(get_opposite(hd))) {
       one_ring_faces.insert(get_face(get_opposite(hd)));
@@ -1417,7 +1970,7 @@ class Mesh_properties {
           min_radian, reduce_complexity, large_error_queue,
           small_value_queue, &halfedges, np);
       } else if (np.relocate_after_local_operations) {
-        std::set<vertex_descriptor> one_ring_vertices;
+        Vertex_set one_ring_vertices;
         collect_incident_vertices(vd, &one_ring_vertices);
         relocate_vertices(input_face_tree, max_error_threshold_value,
           max_error, min_radian, reduce_complexity, large_error_queue,
@@ -1484,8 +2037,8 @@ class Mesh_properties {
       const Point &start_point = get_point(get_source_vertex(h));
       const Point &end_point = get_point(get_target_vertex(h));
       const Point &old_point = get_point(get_opposite_vertex(h));
-      FT radian = calculate_radian(end_point, old_point, start_point);
-      if (radian < MIN_VALUE || CGAL_PI - radian < MIN_VALUE) {
+      FT cosine = calculate_cosine(end_point, old_point, start_point);
+      if (cosine > COS_MIN_VALUE || cosine < -COS_MIN_VALUE) {
         return true;    // degenerate cases
       }
       Plane plane(end_point, old_point, start_point);
@@ -1629,76 +2182,161 @@ class Mesh_properties {
   }
 
   vertex_descriptor construct_local_mesh(
-    const std::set<face_descriptor> &one_ring_faces,
-    const std::set<face_descriptor> &extended_faces,
-    const Halfedge_list &halfedges, const Point &new_point, bool is_ring,
-    Mesh *mesh) const {
-    // construct the 2-manifold surface_mesh
-    // step 1: build the point to index map
-    std::map<Point, size_t, Point_Comp> points_map;
-    // std::set<Point, size_t> points_map;
-    points_map.insert(std::make_pair(new_point, points_map.size()));
-    for (auto it = halfedges.begin(); it != halfedges.end(); ++it) {
-      const Point &p = get_point(get_target_vertex(*it));
-      points_map.insert(std::make_pair(p, points_map.size()));
-    }
-    if (!is_ring) {
-      halfedge_descriptor hd = *(halfedges.begin());
-      hd = get_opposite(hd);
-      const Point &p = get_point(get_target_vertex(hd));
-      points_map.insert(std::make_pair(p, points_map.size()));
-    }
-    std::set<face_descriptor> differ_faces;
+    const Face_set &one_ring_faces,
+    const Face_set &extended_faces,
+    const Halfedge_list &halfedges, const Point &new_point, Mesh *mesh,
+    std::vector<vertex_descriptor> *source_vertices) const {
+    // construct the 2-manifold surface_mesh directly from the connectivity of
+    // mesh_: vertices are identified by their descriptors, so no point
+    // comparison or polygon soup orientation is involved
+    // step 1: collect the vertices of the link and of the untouched faces
+    std::vector<face_descriptor> differ_faces;
     std::set_difference(extended_faces.begin(), extended_faces.end(),
       one_ring_faces.begin(), one_ring_faces.end(),
-      std::inserter(differ_faces, differ_faces.end()));
+      std::back_inserter(differ_faces));
+    std::vector<vertex_descriptor> vertices;
+    vertices.reserve(2 * halfedges.size() + 3 * differ_faces.size());
+    for (auto it = halfedges.begin(); it != halfedges.end(); ++it) {
+      vertices.push_back(get_source_vertex(*it));
+      vertices.push_back(get_target_vertex(*it));
+    }
     for (auto it = differ_faces.begin(); it != differ_faces.end(); ++it) {
       halfedge_descriptor hd = mesh_.halfedge(*it);
-      Point points[3];
-      points[0] = get_point(get_target_vertex(hd));
-      points[1] = get_point(get_opposite_vertex(hd));
-      points[2] = get_point(get_source_vertex(hd));
-      for (int i = 0; i <= 2; ++i) {
-        if (points_map.find(points[i]) == points_map.end()) {
-          points_map.insert(std::make_pair(points[i], points_map.size()));
-        }
+      vertices.push_back(get_target_vertex(hd));
+      vertices.push_back(get_opposite_vertex(hd));
+      vertices.push_back(get_source_vertex(hd));
+    }
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()),
+      vertices.end());
+    // step 2: add the vertices, the new one first
+    size_t nb_faces = halfedges.size() + differ_faces.size();
+    mesh->reserve(vertices.size() + 1, 3 * nb_faces, nb_faces);
+    vertex_descriptor local_vd = mesh->add_vertex(new_point);
+    std::vector<vertex_descriptor> local_vertices;
+    local_vertices.reserve(vertices.size());
+    for (auto it = vertices.begin(); it != vertices.end(); ++it) {
+      local_vertices.push_back(mesh->add_vertex(get_point(*it)));
+    }
+    if (source_vertices != NULL) {  // local vertex index -> mesh_ vertex
+      source_vertices->assign(mesh->number_of_vertices(), get_null_vertex());
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        (*source_vertices)[size_t(local_vertices[i])] = vertices[i];
       }
     }
-    // step 2: build the polygon soups
-    std::vector<size_t> polygon(3, 0);
-    std::vector<std::vector<size_t>> polygons;
+    auto local_vertex = [&](vertex_descriptor vd) {
+      return local_vertices[std::lower_bound(vertices.begin(), vertices.end(),
+        vd) - vertices.begin()];
+    };
+    // step 3: add the faces, with the same orientations as in mesh_
+    std::vector<vertex_descriptor> faces;     // 3 vertices per face
+    faces.reserve(3 * nb_faces);
     for (auto it = halfedges.begin(); it != halfedges.end(); ++it) {
-      const Point &p1 = get_point(get_source_vertex(*it));
-      const Point &p2 = get_point(get_target_vertex(*it));
-      polygon[1] = points_map[p1];
-      polygon[2] = points_map[p2];
-      polygons.push_back(polygon);
+      faces.push_back(local_vd);
+      faces.push_back(local_vertex(get_source_vertex(*it)));
+      faces.push_back(local_vertex(get_target_vertex(*it)));
     }
     for (auto it = differ_faces.begin(); it != differ_faces.end(); ++it) {
       halfedge_descriptor hd = mesh_.halfedge(*it);
-      const Point &p0 = get_point(get_target_vertex(hd));
-      const Point &p1 = get_point(get_opposite_vertex(hd));
-      const Point &p2 = get_point(get_source_vertex(hd));
-      polygon[0] = points_map[p0];
-      polygon[1] = points_map[p1];
-      polygon[2] = points_map[p2];
-      polygons.push_back(polygon);
-    }
-    // step 3: build the 2-manifold mesh
-    std::vector<Point> points(points_map.size());
-    for (auto it = points_map.begin(); it != points_map.end(); ++it) {
-      points[it->second] = it->first;
+      faces.push_back(local_vertex(get_target_vertex(hd)));
+      faces.push_back(local_vertex(get_opposite_vertex(hd)));
+      faces.push_back(local_vertex(get_source_vertex(hd)));
+    }
+    // add_face() fails (and changes nothing) if the face would make a vertex
+    // non-manifold for the faces added so far, which depends on the order.
+    // The failed faces are retried while some progress is made; if some
+    // still fail, the local mesh is not a 2-manifold patch and null_vertex
+    // is returned so that the candidate is rejected.
+    std::vector<vertex_descriptor> failed_faces;
+    while (!faces.empty()) {
+      failed_faces.clear();
+      for (size_t i = 0; i < faces.size(); i += 3) {
+        if (mesh->add_face(faces[i], faces[i + 1], faces[i + 2]) ==
+            Mesh::null_face()) {
+          failed_faces.insert(failed_faces.end(), faces.begin() + i,
+            faces.begin() + i + 3);
+        }
+      }
+      if (failed_faces.size() == faces.size()) {
+        return get_null_vertex();
+      }
+      faces.swap(failed_faces);
     }
-    // PMP::repair_polygon_soup(points, polygons);
-    // PMP::orient_polygon_soup(points, polygons);
-    PMP::polygon_soup_to_polygon_mesh(points, polygons, *mesh);
-    for (typename Mesh::Vertex_range::const_iterator vi = mesh->vertices().begin();
-      vi != mesh->vertices().end(); ++vi) {
-      if (mesh->point(*vi) == new_point) {
-        return *vi;
+    return local_vd;
+  }
+
+  FT calculate_collapse_ring_radius(const Halfedge_list &halfedges,
+    const Point &new_point) const {
+    // the largest distance from new_point to the link of the collapse
+    FT max_sd = 0.0;
+    for (auto it = halfedges.begin(); it != halfedges.end(); ++it) {
+      max_sd = CGAL::max(max_sd, CGAL::squared_distance(new_point,
+        get_point(get_source_vertex(*it))));
+      max_sd = CGAL::max(max_sd, CGAL::squared_distance(new_point,
+        get_point(get_target_vertex(*it))));
+    }
+    return CGAL::sqrt(max_sd);
+  }
+
+  bool collapse_would_exceed_error(
+    const Face_set &one_ring_faces,
+    const Face_set &extended_faces,
+    const Halfedge_list &halfedges, const Point &new_point, FT slack,
+    FT max_error_threshold_value) const {
+    /* conservative check before simulate_edge_collapse: after the collapse,
+    every in link of extended_faces is bound to the local mesh made of the
+    untouched faces and the fan (new_point, source, target) of halfedges.
+    The merged vertex may still move by at most slack during the
+    optimization, which moves every fan point by at most slack as well.
+    So min(d_untouched, d_fan - slack) is a lower bound of the distance
+    of each in link, and if one of them already exceeds the threshold the
+    simulation would be rejected anyway. */
+    Triangle_batch untouched, fan;
+    std::vector<face_descriptor> untouched_faces;
+    Face_set differ_faces;
+    std::set_difference(extended_faces.begin(), extended_faces.end(),
+      one_ring_faces.begin(), one_ring_faces.end(),
+      std::inserter(differ_faces, differ_faces.end()));
+    fill_triangle_batch(differ_faces, &untouched, &untouched_faces);
+    fan.reserve(halfedges.size());
+    for (auto it = halfedges.begin(); it != halfedges.end(); ++it) {
+      const Point &b = get_point(get_source_vertex(*it));
+      const Point &c = get_point(get_target_vertex(*it));
+      fan.add(CGAL::to_double(new_point.x()), CGAL::to_double(new_point.y()),
+        CGAL::to_double(new_point.z()), CGAL::to_double(b.x()),
+        CGAL::to_double(b.y()), CGAL::to_double(b.z()),
+        CGAL::to_double(c.x()), CGAL::to_double(c.y()),
+        CGAL::to_double(c.z()));
+    }
+    FT squared_threshold = max_error_threshold_value *
+      max_error_threshold_value;
+    for (auto it = extended_faces.begin(); it != extended_faces.end(); ++it) {
+      const Link_iter_list &face_in_links = get_face_in_links(*it);
+      for (Link_iter_list_const_iter lit = face_in_links.begin();
+        lit != face_in_links.end(); ++lit) {
+        if (in_link_lower_bound_exceeds(untouched, fan,
+          to_point((*lit)->second.first), slack, squared_threshold)) {
+          return true;
+        }
+      }
+      const Link_iter_list &edge_in_links = get_edge_in_links(*it);
+      for (Link_iter_list_const_iter lit = edge_in_links.begin();
+        lit != edge_in_links.end(); ++lit) {
+        if (in_link_lower_bound_exceeds(untouched, fan,
+          to_point((*lit)->second.first), slack, squared_threshold)) {
+          return true;
+        }
+      }
+      const Link_pointer_list &vertex_in_links = get_vertex_in_links(*it);
+      for (Link_pointer_const_iter lit = vertex_in_links.begin();
+        lit != vertex_in_links.end(); ++lit) {
+        if (in_link_lower_bound_exceeds(untouched, fan,
+          to_point((*lit)->second.first), slack, squared_threshold)) {
+          return true;
+        }
       }
     }
-    return mesh->null_vertex();
+    return false;
   }
 
   vertex_descriptor collapse_edge(const Face_tree &input_face_tree,
@@ -1749,7 +2387,7 @@ class Mesh_properties {
       } while (hb != he);
     }
     // step 4: update local links (optimize already performed in simulation)
-    std::set<face_descriptor> one_ring_faces, extended_faces;
+    Face_set one_ring_faces, extended_faces;
     collect_one_ring_faces_incident_to_vertex(v_joined, &one_ring_faces);
     extend_faces(one_ring_faces, np.stencil_ring_size, &extended_faces);
     generate_local_links(input_face_tree, true, face_in_links, edge_in_links,
@@ -1778,7 +2416,7 @@ class Mesh_properties {
             -1.0, min_radian, reduce_complexity, large_error_queue,
             small_value_queue, &halfedges, np);
       } else if (np.relocate_after_local_operations) {
-        std::set<vertex_descriptor> one_ring_vertices;
+        Vertex_set one_ring_vertices;
         collect_incident_vertices(v_joined, &one_ring_vertices);
         relocate_vertices(input_face_tree, max_error_threshold_value, -1.0,
           min_radian, reduce_complexity, large_error_queue,
@@ -1822,7 +2460,7 @@ class Mesh_properties {
       return get_null_halfedge();
     }
     // step 2: backup the original local links
-    std::set<face_descriptor> one_ring_faces, extended_faces;
+    Face_set one_ring_faces, extended_faces;
     one_ring_faces.insert(get_face(hd));
     one_ring_faces.insert(get_face(get_opposite(hd)));
     extend_faces(one_ring_faces, np.stencil_ring_size, &extended_faces);
@@ -1876,12 +2514,12 @@ class Mesh_properties {
     // step 9: relocate if necessary (only when we want to improve angle)
     if (max_error < 0) {
       if (flipped && np.relocate_after_local_operations) {
-        std::set<vertex_descriptor> vertices;
+        Vertex_set vertices;
         vertices.insert(get_source_vertex(hd));
         vertices.insert(get_target_vertex(hd));
         vertices.insert(get_opposite_vertex(hd));
         vertices.insert(get_opposite_vertex(get_opposite(hd)));
-        std::set<face_descriptor> faces;  // used to calculate local_min_radian
+        Face_set faces;  // used to calculate local_min_radian
         for (auto it = vertices.begin(); it != vertices.end(); ++it) {
           collect_one_ring_faces_incident_to_vertex(*it, &faces);
         }
@@ -1904,7 +2542,7 @@ class Mesh_properties {
     // If reduce_complexity, we update collapse_candidate_queue;
     //    otherwise, we update small_radian_queue.
     // step 1: construct the vertices
-    std::set<vertex_descriptor> incident_vertices;
+    Vertex_set incident_vertices;
     incident_vertices.insert(get_opposite_vertex(hd));
     incident_vertices.insert(get_target_vertex(hd));
     incident_vertices.insert(get_source_vertex(hd));
@@ -1932,16 +2570,16 @@ class Mesh_properties {
       return false;
     }
     // step 2: backup the original local links
-    std::set<face_descriptor> one_ring_faces, extended_faces;
+    Face_set one_ring_faces, extended_faces;
     collect_one_ring_faces_incident_to_vertex(vd, &one_ring_faces);
     extend_faces(one_ring_faces, np.stencil_ring_size, &extended_faces);
     Link_iter_list face_in_links, edge_in_links;
     Link_pointer_list vertex_in_links;
-    std::map<face_descriptor, Link_list> face_out_map;
-    std::map<halfedge_descriptor, Link_list> edge_out_map;
-    Link vertex_out;
-    backup_local_links(extended_faces, &face_out_map, &edge_out_map,
-      &vertex_out, &face_in_links, &edge_in_links, &vertex_in_links, vd);
+    backup_local_in_links(extended_faces, &face_in_links, &edge_in_links,
+      &vertex_in_links);
+    Link_journal journal;
+    open_link_journal(extended_faces, face_in_links, edge_in_links,
+      vertex_in_links, vd, &journal);
     // step 3: remove from queue if necessary
     if (small_value_queue != NULL) {
       remove_small_value_edges_before_relocate(vd, large_error_queue,
@@ -1973,10 +2611,8 @@ class Mesh_properties {
     }
     if (!relocated) {
       relocate_vertex_point(vd, old_point);   // restore back the position
-      restore_local_links(face_out_map, edge_out_map, vertex_out,
-        face_in_links, edge_in_links, vertex_in_links,
-        vd, extended_faces, np);
-      calculate_max_squared_errors(&extended_faces);
+      update_local_feature_intensity(vd, false, np);
+      rollback_link_journal(&journal);
     }
     // step 7: add the queue if necesary
     if (small_value_queue != NULL) {
@@ -1991,7 +2627,7 @@ class Mesh_properties {
   void optimize_vertex_position(const Face_tree &input_face_tree,
     const Link_iter_list &face_in_links, const Link_iter_list &edge_in_links,
     const Link_pointer_list &vertex_in_links, vertex_descriptor vd,
-    const std::set<face_descriptor> &in_link_faces,
+    const Face_set &in_link_faces,
     const NamedParameters &np) {
     // precondition: the samples have been generated
     for (int i = 0; i < np.vertex_optimize_count; ++i) {
@@ -2044,42 +2680,44 @@ class Mesh_properties {
 
   static FT calculate_smallest_radian(
       const Point &a, const Point &b, const Point &c) {
+    return std::acos(calculate_largest_cosine(a, b, c));
+  }
+
+  static FT calculate_largest_cosine(
+      const Point &a, const Point &b, const Point &c) {
+    // the cosine of the smallest angle (opposite to the shortest side)
     FT ab = CGAL::squared_distance(a, b);
     FT ac = CGAL::squared_distance(a, c);
     FT bc = CGAL::squared_distance(b, c);
     if (ab < ac) {
-      return ab < bc ? calculate_radian(b, c, a) : calculate_radian(c, a, b);
+      return ab < bc ? calculate_cosine(b, c, a) : calculate_cosine(c, a, b);
     } else {
-      return ac < bc ? calculate_radian(a, b, c) : calculate_radian(c, a, b);
+      return ac < bc ? calculate_cosine(a, b, c) : calculate_cosine(c, a, b);
     }
   }
 
   static FT calculate_radian(const Point &a, const Point &b, const Point &c) {
-    if (CGAL::squared_distance(a, b) < SQUARED_MIN_VALUE ||
-      CGAL::squared_distance(a, c) < SQUARED_MIN_VALUE ||
-      CGAL::squared_distance(b, c) < SQUARED_MIN_VALUE) {
-      return 0.0;   // degenerated case
-    }
+    return std::acos(calculate_cosine(a, b, c));
+  }
+
+  static FT calculate_cosine(const Point &a, const Point &b, const Point &c) {
+    // cosine of the angle abc; smaller angles have larger cosines, so the
+    // comparisons can be done without acos
     Vector v1 = a - b;        // v1
-    FT v1_length = std::sqrt(v1 * v1);
-    if (v1_length < MIN_VALUE) {
-      return 0.0;
-    }
-    v1 = v1 / v1_length;
     Vector v2 = c - b;        // v2
-    FT v2_length = std::sqrt(v2 * v2);
-    if (v2_length < MIN_VALUE) {
-      return 0.0;
+    FT v1_sl = v1 * v1, v2_sl = v2 * v2;
+    if (v1_sl < SQUARED_MIN_VALUE || v2_sl < SQUARED_MIN_VALUE ||
+      CGAL::squared_distance(a, c) < SQUARED_MIN_VALUE) {
+      return 1.0;   // degenerated case (radian 0)
     }
-    v2 = v2 / v2_length;
-    FT cos_value = v1 * v2;
+    FT cos_value = (v1 * v2) / std::sqrt(v1_sl * v2_sl);
     if (cos_value > 1.0) {
       cos_value = 1.0;
     }
     if (cos_value < -1.0) {
       cos_value = -1.0;
     }
-    return std::acos(cos_value);
+    return cos_value;
   }
 
   static FT calculate_angle(const Point &a, const Point &b, const Point &c) {
@@ -2381,18 +3019,18 @@ class Mesh_properties {
   }
 
   FT calculate_minimal_radian_incident_to_vertex(vertex_descriptor vd) const {
-    FT minimal_radian = CGAL_PI;
+    FT largest_cosine = -1.0;
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
       if (!is_border(*hb)) {
-        FT radian = calculate_radian(get_point(get_source_vertex(*hb)),
+        FT cosine = calculate_cosine(get_point(get_source_vertex(*hb)),
           get_point(get_target_vertex(*hb)),
           get_point(get_opposite_vertex(*hb)));
-        minimal_radian = CGAL::min(minimal_radian, radian);
+        largest_cosine = CGAL::max(largest_cosine, cosine);
       }
       ++hb;
     } while (hb != he);
-    return minimal_radian;
+    return std::acos(largest_cosine);
   }
 
   FT calculate_min_squared_distance_in_one_ring_faces(
@@ -2414,23 +3052,10 @@ class Mesh_properties {
   }
 
   // 3.2) face properties
-  halfedge_descriptor get_shortest_halfedge(face_descriptor fd) {
-    halfedge_descriptor hd = mesh_.halfedge(fd);
-    halfedge_descriptor shortest_hd = hd;
-    FT shortest_sl = squared_length(shortest_hd);
-    FT sl = squared_length(mesh_.next(hd));   // check the next halfedge
-    if (sl < shortest_sl) {
-      shortest_sl = sl;
-      shortest_hd = mesh_.next(hd);
-    }
-    sl = squared_length(mesh_.prev(hd));      // check the previous halfedge
-    if (sl < shortest_sl) {
-      shortest_hd = mesh_.prev(hd);
-    }
-    return shortest_hd;
-  }
-
   halfedge_descriptor get_shortest_halfedge(face_descriptor fd) const {
+    if (use_face_geometry_cache_) {
+      return get_face_geometry(fd).shortest_hd;
+    }
     halfedge_descriptor hd = mesh_.halfedge(fd);
     halfedge_descriptor shortest_hd = hd;
     FT shortest_sl = squared_length(shortest_hd);
@@ -2447,8 +3072,15 @@ class Mesh_properties {
   }
 
   FT calculate_smallest_radian(face_descriptor fd) const {
+    return std::acos(calculate_largest_cosine(fd));
+  }
+
+  FT calculate_largest_cosine(face_descriptor fd) const {
+    if (use_face_geometry_cache_) {
+      return get_face_geometry(fd).largest_cosine;
+    }
     halfedge_descriptor shortest_hd = get_shortest_halfedge(fd);
-    return calculate_opposite_radian(shortest_hd);
+    return calculate_opposite_cosine(shortest_hd);
   }
 
   FT calculate_smallest_angle(face_descriptor fd) const {
@@ -2467,6 +3099,9 @@ class Mesh_properties {
   }
 
   FT calculate_quality(face_descriptor fd) const {
+    if (use_face_geometry_cache_) {
+      return get_face_geometry(fd).quality;
+    }
     halfedge_descriptor hd = mesh_.halfedge(fd);
     FT s_t = area(fd);                          // area of the triangle
     FT h_t = length(get_longest_halfedge(fd));  // longest edge
@@ -2482,17 +3117,16 @@ class Mesh_properties {
   }
 
   FT calculate_local_minimal_radian(
-    const std::set<face_descriptor> &faces) const {
-    FT minimal_radian = CGAL_PI;
+    const Face_set &faces) const {
+    FT largest_cosine = -1.0;
     for (auto it = faces.begin(); it != faces.end(); ++it) {
-      face_descriptor fd = *it;
-      FT radian = calculate_smallest_radian(fd);
-      minimal_radian = CGAL::min(minimal_radian, radian);
+      largest_cosine = CGAL::max(largest_cosine,
+        calculate_largest_cosine(*it));
     }
-    return minimal_radian;
+    return std::acos(largest_cosine);
   }
 
-  FT calculate_sum_qem_value(const std::set<face_descriptor> &faces,
+  FT calculate_sum_qem_value(const Face_set &faces,
     const Point &point) const {
     FT sum_qem_value = 0.0;
     for (auto it = faces.begin(); it != faces.end(); ++it) {
@@ -2515,7 +3149,7 @@ class Mesh_properties {
     return sum_area;
   }
 
-  void calculate_local_normals(std::set<face_descriptor> *faces) {
+  void calculate_local_normals(Face_set *faces) {
     Normal normal;
     for (auto fit = faces->begin(); fit != faces->end(); ++fit) {
       normal = PMP::compute_face_normal(*fit, mesh_, PMP::parameters::
@@ -2537,6 +3171,13 @@ class Mesh_properties {
     }
   }
 
+  inline FT calculate_opposite_cosine(halfedge_descriptor hd) const {
+    CGAL_precondition(!is_border(hd));
+    return calculate_cosine(get_point(get_target_vertex(hd)),
+      get_point(get_opposite_vertex(hd)),
+      get_point(get_source_vertex(hd)));
+  }
+
   inline FT calculate_opposite_angle(halfedge_descriptor hd) const {
     FT radian = get_opposite_radian(hd);
     return to_angle(radian);
@@ -2559,7 +3200,7 @@ class Mesh_properties {
   }
 
   Point get_least_qem_point(halfedge_descriptor hd) const {
-    std::set<face_descriptor> faces;
+    Face_set faces;
     collect_one_ring_faces_incident_to_edge(hd, &faces);
     const Point &start_point = get_point(get_source_vertex(hd));
     const Point mid_point = midpoint(hd);
@@ -2591,6 +3232,30 @@ class Mesh_properties {
   }
 
   // 4) samples and links
+  FT calculate_sample_density_factor(face_descriptor fd) const {
+    // step 1: feature factor, linear from 0.5 on flat faces to 2 on the
+    // strongest features (the feature intensities are in [1, (PI + 1) ^ 2])
+    halfedge_descriptor hd = mesh_.halfedge(fd);
+    FT feature_intensity =
+      (calculate_feature_intensity(get_target_vertex(hd)) +
+      calculate_feature_intensity(get_opposite_vertex(hd)) +
+      calculate_feature_intensity(get_source_vertex(hd))) / 3.0;
+    FT max_feature_intensity = (CGAL_PI + 1) * (CGAL_PI + 1);
+    FT feature_factor = 0.5 + 1.5 * (feature_intensity - 1.0) /
+      (max_feature_intensity - 1.0);
+    feature_factor = CGAL::min(CGAL::max(feature_factor, FT(0.5)), FT(2.0));
+    // step 2: error factor, 0.5 if the observed max error is far below the
+    // threshold and up to 2 near it (new faces inherit their source errors),
+    // 1 until the errors have been measured
+    FT error_factor = 1.0;
+    if (max_squared_error_threshold_ > 0.0 && max_squared_errors_measured_) {
+      FT ratio = CGAL::sqrt(get_face_max_squared_error(fd) /
+        max_squared_error_threshold_);
+      error_factor = CGAL::min(FT(0.5 + 2.0 * ratio), FT(2.0));
+    }
+    return feature_factor * error_factor;
+  }
+
   void calculate_nb_samples_per_face(int nb_samples_per_face_value,
     const Face_list &faces, const NamedParameters &np) {
     // the nb_sample is recorded in face_tags_
@@ -2618,9 +3283,10 @@ class Mesh_properties {
       }
     } else {
       // SampleStrategy::k_adaptive, samples per face is the same
+      // (SampleStrategy::k_error_driven scales it by a density factor)
       for (auto it = faces.begin(); it != faces.end(); ++it) {
         face_descriptor fd = *it;
-        std::set<face_descriptor> incident_faces;
+        Face_set incident_faces;
         collect_incident_faces(fd, &incident_faces);
         FT sum_area = 0.0;
         for (auto it2 = incident_faces.begin();
@@ -2628,8 +3294,12 @@ class Mesh_properties {
           sum_area += area(*it2);
         }
         FT face_area = area(fd);
+        FT density = 1.0;
+        if (np.sample_strategy == SampleStrategy::k_error_driven) {
+          density = calculate_sample_density_factor(fd);
+        }
         int nb_face_samples = static_cast<int>(incident_faces.size() *
-          nb_samples_per_face_value * face_area / sum_area);
+          nb_samples_per_face_value * density * face_area / sum_area);
         int nb_max_samples = np.max_samples_per_area * face_area;
         nb_face_samples = std::min(nb_face_samples, nb_max_samples);
         nb_face_samples = std::max(nb_face_samples,
@@ -2640,7 +3310,7 @@ class Mesh_properties {
   }
 
   void clear_local_links(halfedge_descriptor hd,
-    const std::set<face_descriptor> &in_link_faces) {
+    const Face_set &in_link_faces) {
     // step 1: clear all in link faces
     clear_local_in_links(in_link_faces);
     // step 2: clear the out links in faces that are incident to hd
@@ -2663,7 +3333,7 @@ class Mesh_properties {
   }
 
   void clear_local_links(vertex_descriptor vd,
-    const std::set<face_descriptor> &in_link_faces) {
+    const Face_set &in_link_faces) {
     // step 1: clear all in links in in_link_faces
     clear_local_in_links(in_link_faces);
     // step 2: clear the out links in one-ring faces of vd
@@ -2683,7 +3353,7 @@ class Mesh_properties {
     } while (hb != he);
   }
 
-  void clear_local_in_links(const std::set<face_descriptor> &faces) {
+  void clear_local_in_links(const Face_set &faces) {
     for (auto it = faces.begin(); it != faces.end(); ++it) {
       // step 1: clear the links
       face_descriptor fd = *it;
@@ -2693,8 +3363,9 @@ class Mesh_properties {
       face_in_links.clear();
       edge_in_links.clear();
       vertex_in_inks.clear();
-      // step 2: update the max squared_error
-      set_face_max_squared_error(fd, 0.0);
+      // step 2: the max squared errors are kept until
+      // calculate_max_squared_errors() recomputes them, the out links
+      // generated in between are sampled according to them
     }
   }
 
@@ -2715,32 +3386,64 @@ class Mesh_properties {
 
   void generate_face_links(const Face_tree &face_tree,
     Mesh_properties *mesh_properties, int bvd_iteration_count_value,
-    bool use_stratified_sampling, const Face_list &faces) {
-    Point_list inner_samples;
+    bool use_stratified_sampling, const Face_list &faces,
+    int nb_threads) {
+    // step 1: sample the faces concurrently (nb_threads <= 0 uses all the
+    // cores); each face owns its samples, random generator and Bvd, and
+    // area() only caches the geometry of its own face
+    std::vector<face_descriptor> sampled_faces;
+    for (auto it = faces.begin(); it != faces.end(); ++it) {
+      if (get_face_tag(*it) > 0) {
+        sampled_faces.push_back(*it);
+      }
+    }
+    std::vector<Point_list> inner_samples(sampled_faces.size());
+    std::vector<std::list<double>> feature_weights(sampled_faces.size());
+    auto sample_faces = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i != end; ++i) {
+        generate_random_samples(use_stratified_sampling,
+          get_face_tag(sampled_faces[i]), bvd_iteration_count_value,
+          sampled_faces[i], &inner_samples[i], &feature_weights[i]);
+      }
+    };
+    bool sampled = false;
+#ifdef CGAL_LINKED_WITH_TBB
+    if (nb_threads != 1 && sampled_faces.size() > 1) {
+      tbb::task_arena arena(nb_threads > 0 ?
+        nb_threads : tbb::task_arena::automatic);
+      arena.execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0,
+          sampled_faces.size()),
+          [&](const tbb::blocked_range<std::size_t> &range) {
+          sample_faces(range.begin(), range.end());
+        });
+      });
+      sampled = true;
+    }
+#endif
+    if (!sampled) {
+      sample_faces(0, sampled_faces.size());
+    }
+    // step 2: link the samples in the face order
     Point_const_iter pit;
-    std::list<double> feature_weights;
     std::list<double>::const_iterator fit;
     Point_and_primitive_id pp;
-    for (auto it = faces.begin(); it != faces.end(); ++it) {
-      face_descriptor fd = *it;
+    for (std::size_t i = 0; i < sampled_faces.size(); ++i) {
+      face_descriptor fd = sampled_faces[i];
       int nb_samples = get_face_tag(fd);
-      if (nb_samples > 0) {
-        generate_random_samples(use_stratified_sampling, nb_samples,
-          bvd_iteration_count_value, fd, &inner_samples, &feature_weights);
-        FT capacity = use_stratified_sampling ? area(fd) / nb_samples : 1.0;
-        Link_list &face_out_links = get_face_out_links(fd);
-        for (pit = inner_samples.begin(), fit = feature_weights.begin();
-          pit != inner_samples.end(); ++pit, ++fit) {
-          pp = face_tree.closest_point_and_primitive(*pit);
-          // 1) insert the sample in the source
-          Link_list_iter it = face_out_links.insert(face_out_links.end(),
-            std::make_pair(capacity * (*fit),
-            std::make_pair(*pit, pp.first)));
-          // 2) insert the samples in the target if necessary
-          if (mesh_properties != NULL) {
-            face_descriptor closest_fd = pp.second;   // closest fd
-            mesh_properties->get_face_in_links(closest_fd).push_back(it);
-          }
+      FT capacity = use_stratified_sampling ? area(fd) / nb_samples : 1.0;
+      Link_list &face_out_links = get_face_out_links(fd);
+      for (pit = inner_samples[i].begin(), fit = feature_weights[i].begin();
+        pit != inner_samples[i].end(); ++pit, ++fit) {
+        pp = face_tree.closest_point_and_primitive(*pit);
+        // 1) insert the sample in the source
+        Link_list_iter it = face_out_links.insert(face_out_links.end(),
+          std::make_pair(capacity * (*fit),
+          std::make_pair(to_link_point(*pit), to_link_point(pp.first))));
+        // 2) insert the samples in the target if necessary
+        if (mesh_properties != NULL) {
+          face_descriptor closest_fd = pp.second;   // closest fd
+          mesh_properties->get_face_in_links(closest_fd).push_back(it);
         }
       }
     }
@@ -2794,9 +3497,10 @@ class Mesh_properties {
       // step 1.1: generate the unique inner samples
       std::set<Point, Point_Comp> samples;
       // std::set<Point> samples;
-      boost::random::mt19937 gen(time(NULL));
+      // one generator per face, so that faces can be sampled concurrently
+      boost::random::mt19937 gen(static_cast<unsigned int>(time(NULL)) +
+        static_cast<unsigned int>(fd));
       boost::random::uniform_01<> random;
-      srand(time(NULL));
       Vector ab = b - a, ac = c - a;  // edge vectors
       while (samples.size() < nb_samples) {
         FT u = 0.0, v = 0.0;
@@ -2900,7 +3604,7 @@ class Mesh_properties {
       // 1) insert the sample in the source
       Link_list_iter it = edge_out_links.insert(edge_out_links.end(),
         std::make_pair(feature_weight * capacity,
-        std::make_pair(sample, pp.first)));
+        std::make_pair(to_link_point(sample), to_link_point(pp.first))));
       // 2) insert the iterator in the target if necessary
       if (mesh_properties != NULL) {
         face_descriptor fd = pp.second;  // closest fd
@@ -2928,8 +3632,8 @@ class Mesh_properties {
     // 1) insert the sample in the source
     Link& vertex_out_link = get_vertex_out_link(vd);
     vertex_out_link.first = capacity * calculate_feature_intensity(vd);
-    vertex_out_link.second.first = get_point(vd);
-    vertex_out_link.second.second = pp.first;
+    vertex_out_link.second.first = to_link_point(get_point(vd));
+    vertex_out_link.second.second = to_link_point(pp.first);
     // 2) insert the sample in the target if necessary
     if (mesh_properties != NULL) {
       face_descriptor fd = pp.second;  // closest fd
@@ -2941,7 +3645,7 @@ class Mesh_properties {
     bool reset_normal_dihedral, const Link_iter_list &face_in_links,
     const Link_iter_list &edge_in_links,
     const Link_pointer_list &vertex_in_links,
-    halfedge_descriptor hd, const std::set<face_descriptor> &in_link_faces,
+    halfedge_descriptor hd, const Face_set &in_link_faces,
     const NamedParameters &np) {
     // step 1: update the local feature_intensity around endpoints of hd
     vertex_descriptor vp = get_source_vertex(hd);
@@ -2970,7 +3674,7 @@ class Mesh_properties {
     generate_edge_links(face_tree, NULL, edges, np);
     generate_vertex_links(face_tree, NULL, np.use_stratified_sampling);
     generate_face_links(face_tree, NULL, np.bvd_iteration_count,
-      np.use_stratified_sampling, faces);
+      np.use_stratified_sampling, faces, 1);   // few faces: sequential
     // step 4: reset the face tags
     reset_face_tags(0, faces);
   }
@@ -2987,12 +3691,12 @@ class Mesh_properties {
     // step 3: generate out links (is_in_links is set to false)
     generate_edge_links(face_tree, NULL, edges, np);
     generate_face_links(face_tree, NULL, np.bvd_iteration_count,
-      np.use_stratified_sampling, faces);
+      np.use_stratified_sampling, faces, 1);   // few faces: sequential
     // step 4: reset the face tags
     reset_face_tags(0, faces);
   }
 
-  void generate_local_in_links(const std::set<face_descriptor> &in_link_faces,
+  void generate_local_in_links(const Face_set &in_link_faces,
     const Link_iter_list &face_in_links, const Link_iter_list &edge_in_links,
     const Link_pointer_list &vertex_in_links, bool use_local_aabb_tree) {
     Point_and_primitive_id pp;
@@ -3007,90 +3711,158 @@ class Mesh_properties {
       for (Link_iter_list_const_iter it = face_in_links.begin();
         it != face_in_links.end(); ++it) {
         Link_list_iter llit = *it;
-        pp = local_face_tree.closest_point_and_primitive(llit->second.first);
-        llit->second.second = pp.first;   // update the closest point
+        pp = local_face_tree.closest_point_and_primitive(
+          to_point(llit->second.first));
+        llit->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_face_in_links(closest_fd).push_back(llit);
       }
       for (Link_iter_list_const_iter it = edge_in_links.begin();
         it != edge_in_links.end(); ++it) {
         Link_list_iter llit = *it;
-        pp = local_face_tree.closest_point_and_primitive(llit->second.first);
-        llit->second.second = pp.first;   // update the closest point
+        pp = local_face_tree.closest_point_and_primitive(
+          to_point(llit->second.first));
+        llit->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_edge_in_links(closest_fd).push_back(llit);
       }
       for (Link_pointer_const_iter it = vertex_in_links.begin();
         it != vertex_in_links.end(); ++it) {
         Link *link = *it;
-        pp = local_face_tree.closest_point_and_primitive(link->second.first);
-        link->second.second = pp.first;   // update the closest point
+        pp = local_face_tree.closest_point_and_primitive(
+          to_point(link->second.first));
+        link->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_vertex_in_links(closest_fd).push_back(link);
       }
     } else {
-      // for each sample, update its closest point, push back to the primitive
+      // step 1: gather the triangles once for the batched distance kernel
+      Triangle_batch batch;
+      std::vector<face_descriptor> batch_faces;
+      fill_triangle_batch(in_link_faces, &batch, &batch_faces);
+      // step 2: for each sample, update its closest point and push back
       for (Link_iter_list_const_iter it = face_in_links.begin();
         it != face_in_links.end(); ++it) {
         Link_list_iter llit = *it;
-        pp = get_closest_point_and_primitive(in_link_faces,
-          llit->second.first);
-        llit->second.second = pp.first;   // update the closest point
+        pp = get_closest_point_and_primitive(batch, batch_faces,
+          to_point(llit->second.first));
+        llit->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_face_in_links(closest_fd).push_back(llit);
       }
       for (Link_iter_list_const_iter it = edge_in_links.begin();
         it != edge_in_links.end(); ++it) {
         Link_list_iter llit = *it;
-        pp = get_closest_point_and_primitive(in_link_faces,
-          llit->second.first);
-        llit->second.second = pp.first;   // update the closest point
+        pp = get_closest_point_and_primitive(batch, batch_faces,
+          to_point(llit->second.first));
+        llit->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_edge_in_links(closest_fd).push_back(llit);
       }
       for (Link_pointer_const_iter it = vertex_in_links.begin();
         it != vertex_in_links.end(); ++it) {
         Link *link = *it;
-        pp = get_closest_point_and_primitive(in_link_faces,
-          link->second.first);
-        link->second.second = pp.first;   // update the closest point
+        pp = get_closest_point_and_primitive(batch, batch_faces,
+          to_point(link->second.first));
+        link->second.second = to_link_point(pp.first);   // the closest point
         closest_fd = pp.second;
         get_vertex_in_links(closest_fd).push_back(link);
       }
     }
   }
 
-  void backup_local_links(const std::set<face_descriptor> &extended_faces,
-    std::map<face_descriptor, Link_list> *face_out_map,
-    std::map<halfedge_descriptor, Link_list> *edge_out_map,
-    Link *vertex_out, Link_iter_list *face_in_links,
-    Link_iter_list *edge_in_links, Link_pointer_list *vertex_in_links,
-    vertex_descriptor vd) const {
-    // step 1: backup the out links
+  void open_link_journal(const Face_set &extended_faces,
+    const Link_iter_list &face_in_links, const Link_iter_list &edge_in_links,
+    const Link_pointer_list &vertex_in_links, vertex_descriptor vd,
+    Link_journal *journal) {
+    // moves the link lists that generate_local_links rebuilds aside (O(1)
+    // per list) and records the end points it overwrites, so a rejected
+    // relocation is undone in place instead of copying the stencil links
+    // step 1: the out links of the one-ring faces, edges and vd
+    journal->face_out_links.reserve(mesh_.degree(vd));
+    journal->edge_out_links.reserve(mesh_.degree(vd));
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
       halfedge_descriptor hd = *hb;
       if (!is_border(hd)) {
         face_descriptor fd = get_face(hd);
-        const Link_list &face_out_links = get_face_out_links(fd);
-        (*face_out_map)[fd].insert((*face_out_map)[fd].end(),
-          face_out_links.begin(), face_out_links.end());
+        journal->face_out_links.push_back(std::make_pair(fd, Link_list()));
+        journal->face_out_links.back().second.swap(get_face_out_links(fd));
       }
       if (get_halfedge_normal_dihedral(hd) == -1.0) {
         hd = get_opposite(hd);
       }
-      const Link_list &edge_out_links = get_halfedge_out_links(hd);
-      (*edge_out_map)[hd].insert((*edge_out_map)[hd].end(),
-        edge_out_links.begin(), edge_out_links.end());
+      journal->edge_out_links.push_back(std::make_pair(hd, Link_list()));
+      journal->edge_out_links.back().second.swap(get_halfedge_out_links(hd));
       ++hb;
     } while (hb != he);
-    (*vertex_out) = get_vertex_out_link(vd);
-    // step 2: backup the in links
-    backup_local_in_links(extended_faces, face_in_links, edge_in_links,
-      vertex_in_links);
-  }
-
-  void backup_local_in_links(const std::set<face_descriptor> &extended_faces,
+    journal->vd = vd;
+    journal->vertex_out_link = get_vertex_out_link(vd);
+    // step 2: the in link lists and max errors of the extended faces
+    journal->in_link_faces.assign(extended_faces.begin(),
+      extended_faces.end());
+    size_t nb_faces = journal->in_link_faces.size();
+    journal->face_in_links.resize(nb_faces);
+    journal->edge_in_links.resize(nb_faces);
+    journal->vertex_in_links.resize(nb_faces);
+    journal->max_squared_errors.resize(nb_faces);
+    for (size_t i = 0; i < nb_faces; ++i) {
+      face_descriptor fd = journal->in_link_faces[i];
+      journal->face_in_links[i].swap(get_face_in_links(fd));
+      journal->edge_in_links[i].swap(get_edge_in_links(fd));
+      journal->vertex_in_links[i].swap(get_vertex_in_links(fd));
+      journal->max_squared_errors[i] = get_face_max_squared_error(fd);
+    }
+    // step 3: the end points of the in links
+    journal->in_link_end_points.reserve(face_in_links.size() +
+      edge_in_links.size() + vertex_in_links.size());
+    for (Link_iter_list_const_iter it = face_in_links.begin();
+      it != face_in_links.end(); ++it) {
+      Link &link = **it;
+      journal->in_link_end_points.push_back(
+        std::make_pair(&link, link.second.second));
+    }
+    for (Link_iter_list_const_iter it = edge_in_links.begin();
+      it != edge_in_links.end(); ++it) {
+      Link &link = **it;
+      journal->in_link_end_points.push_back(
+        std::make_pair(&link, link.second.second));
+    }
+    for (Link_pointer_const_iter it = vertex_in_links.begin();
+      it != vertex_in_links.end(); ++it) {
+      journal->in_link_end_points.push_back(
+        std::make_pair(*it, (*it)->second.second));
+    }
+  }
+
+  void rollback_link_journal(Link_journal *journal) {
+    // precondition: the vertex has been moved back to its old position
+    // step 1: put the out link lists back, the rebuilt ones are dropped
+    for (auto it = journal->face_out_links.begin();
+      it != journal->face_out_links.end(); ++it) {
+      get_face_out_links(it->first).swap(it->second);
+    }
+    for (auto it = journal->edge_out_links.begin();
+      it != journal->edge_out_links.end(); ++it) {
+      get_halfedge_out_links(it->first).swap(it->second);
+    }
+    get_vertex_out_link(journal->vd) = journal->vertex_out_link;
+    // step 2: put the in link lists and the max errors back
+    for (size_t i = 0; i < journal->in_link_faces.size(); ++i) {
+      face_descriptor fd = journal->in_link_faces[i];
+      get_face_in_links(fd).swap(journal->face_in_links[i]);
+      get_edge_in_links(fd).swap(journal->edge_in_links[i]);
+      get_vertex_in_links(fd).swap(journal->vertex_in_links[i]);
+      set_face_max_squared_error(fd, journal->max_squared_errors[i]);
+    }
+    // step 3: restore the overwritten end points
+    for (auto it = journal->in_link_end_points.begin();
+      it != journal->in_link_end_points.end(); ++it) {
+      it->first->second.second = it->second;
+    }
+  }
+
+  void backup_local_in_links(const Face_set &extended_faces,
     Link_iter_list *face_in_links, Link_iter_list *edge_in_links,
     Link_pointer_list *vertex_in_links) const {
     for (auto it = extended_faces.begin(); it != extended_faces.end(); ++it) {
@@ -3110,56 +3882,15 @@ class Mesh_properties {
     }
   }
 
-  void restore_local_links(
-    const std::map<face_descriptor, Link_list> &face_out_map,
-    const std::map<halfedge_descriptor, Link_list> &edge_out_map,
-    const Link &vertex_out, const Link_iter_list &face_in_links,
-    const Link_iter_list &edge_in_links,
-    const Link_pointer_list &vertex_in_links,
-    vertex_descriptor vd, const std::set<face_descriptor> &in_link_faces,
-    const NamedParameters &np) {
-    // only for relocate purpose
-    // step 1: update the local feature_intensity around vh
-    update_local_feature_intensity(vd, false, np);
-    // step 2: clear local_links
-    clear_local_links(vd, in_link_faces);
-    // step 3: restore local out links
-    restore_local_out_links(face_out_map, edge_out_map, vertex_out, vd);
-    // step 4: generate local in links
-    generate_local_in_links(in_link_faces, face_in_links, edge_in_links,
-      vertex_in_links, np.use_local_aabb_tree);
-  }
-
-  void restore_local_out_links(
-    const std::map<face_descriptor, Link_list> &face_out_map,
-    const std::map<halfedge_descriptor, Link_list> &edge_out_map,
-    const Link &vertex_out, vertex_descriptor vd) {
-    // step 1: restore the face out links
-    for (auto it = face_out_map.begin(); it != face_out_map.end(); ++it) {
-      face_descriptor fd = it->first;
-      Link_list &face_out_links = get_face_out_links(fd);
-      face_out_links.insert(face_out_links.end(),
-        it->second.begin(), it->second.end());
-    }
-    // step 2: restore the edge out links
-    for (auto it = edge_out_map.begin(); it != edge_out_map.end(); ++it) {
-      halfedge_descriptor hd = it->first;
-      Link_list &edge_out_links = get_halfedge_out_links(hd);
-      edge_out_links.insert(edge_out_links.end(),
-        it->second.begin(), it->second.end());
-    }
-    // step 3: restore the vertex out link
-    get_vertex_out_link(vd) = vertex_out;
-  }
-
   // 5) queues
 
   // 5.1) for eliminating degenerated faces
   void fill_degenerated_faces_queue(FT radian_threshold,
     DPQueue_face_long *queue) const {
+    FT cosine_threshold = std::cos(radian_threshold);
     for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
       fi != mesh_.faces().end(); ++fi) {
-      if (calculate_smallest_radian(*fi) < radian_threshold) {
+      if (calculate_largest_cosine(*fi) > cosine_threshold) {
         halfedge_descriptor hd = get_longest_halfedge(*fi);
         queue->insert(Face_long(*fi, squared_length(hd)));
       }
@@ -3203,7 +3934,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_one_ring_faces_incident_to_edge(hd, &one_ring_faces);
     remove_small_value_edges(one_ring_faces, large_error_queue,
       small_value_queue, np);
@@ -3214,7 +3945,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_one_ring_faces_incident_to_vertex(vd, &one_ring_faces);
     add_small_value_edges(one_ring_faces, max_error_threshold_value,
       reduce_complexity, large_error_queue, small_value_queue, np);
@@ -3224,7 +3955,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_faces_incident_to_edge(hd, &one_ring_faces);
     remove_small_value_edges(one_ring_faces, large_error_queue,
       small_value_queue, np);
@@ -3235,7 +3966,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_one_ring_faces_incident_to_vertex(vd, &one_ring_faces);
     add_small_value_edges(one_ring_faces, max_error_threshold_value,
       reduce_complexity, large_error_queue, small_value_queue, np);
@@ -3245,7 +3976,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_faces_incident_to_edge(hd, &one_ring_faces);
     remove_small_value_edges(one_ring_faces, large_error_queue,
       small_value_queue, np);
@@ -3256,7 +3987,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_faces_incident_to_edge(hd, &one_ring_faces);
     add_small_value_edges(one_ring_faces, max_error_threshold_value,
       reduce_complexity, large_error_queue, small_value_queue, np);
@@ -3266,7 +3997,7 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_one_ring_faces_incident_to_vertex(vd, &one_ring_faces);
     remove_small_value_edges(one_ring_faces, large_error_queue,
       small_value_queue, np);
@@ -3277,20 +4008,20 @@ class Mesh_properties {
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
-    std::set<face_descriptor> one_ring_faces;
+    Face_set one_ring_faces;
     collect_one_ring_faces_incident_to_vertex(vd, &one_ring_faces);
     add_small_value_edges(one_ring_faces, max_error_threshold_value,
       reduce_complexity, large_error_queue, small_value_queue, np);
   }
 
   void remove_small_value_edges(
-    const std::set<face_descriptor> &one_ring_faces,
+    const Face_set &one_ring_faces,
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
     const NamedParameters &np) const {
     // small_value_queue may be small_radian_queue or collapse_candidate_queue
     // step 1: remove from small_value_queue
-    typename std::set<face_descriptor>::iterator it;
+    typename Face_set::iterator it;
     for (it = one_ring_faces.begin(); it != one_ring_faces.end(); ++it) {
       face_descriptor fd = *it;
       halfedge_descriptor hd = mesh_.halfedge(fd);
@@ -3300,7 +4031,7 @@ class Mesh_properties {
     }
     // step 2: remove from large_error_queue if necesary
     if (np.decrease_max_errors) {
-      std::set<face_descriptor> extended_faces;
+      Face_set extended_faces;
       extend_faces(one_ring_faces, np.stencil_ring_size, &extended_faces);
       for (it = extended_faces.begin(); it != extended_faces.end(); ++it) {
         face_descriptor fd = *it;
@@ -3312,7 +4043,7 @@ class Mesh_properties {
     }
   }
 
-  void add_small_value_edges(const std::set<face_descriptor> &one_ring_faces,
+  void add_small_value_edges(const Face_set &one_ring_faces,
     FT max_error_threshold_value, bool reduce_complexity,
     DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_value_queue,
@@ -3320,7 +4051,7 @@ class Mesh_properties {
     // small_value_queue may be small_radian_queue or collapse_candidate_queue
     // If is former, the prority is radian; otherwise it is length * radian
     // step 1: add to small_value_queue
-    typename std::set<face_descriptor>::iterator it;
+    typename Face_set::iterator it;
     if (reduce_complexity) {    // for min rdian improvement
       for (it = one_ring_faces.begin(); it != one_ring_faces.end(); ++it) {
         face_descriptor fd = *it;
@@ -3333,14 +4064,14 @@ class Mesh_properties {
         }
       }
     } else {                    // for mesh complexity reduction
-      FT min_radian_threshold = to_radian(np.min_angle_threshold);
+      FT cosine_threshold = std::cos(to_radian(np.min_angle_threshold));
       for (it = one_ring_faces.begin(); it != one_ring_faces.end(); ++it) {
         face_descriptor fd = *it;
         halfedge_descriptor hd = mesh_.halfedge(fd);
         for (int i = 0; i <= 2; ++i) {
-          FT radian = calculate_opposite_radian(hd);
-          if (radian < min_radian_threshold) {
-            small_value_queue->insert(Halfedge_short(hd, radian));
+          FT cosine = calculate_opposite_cosine(hd);
+          if (cosine > cosine_threshold) {
+            small_value_queue->insert(Halfedge_short(hd, std::acos(cosine)));
           }
           hd = mesh_.next(hd);
         }
@@ -3349,7 +4080,7 @@ class Mesh_properties {
     // step 2: add to large_error_queue if necessary
     if (np.decrease_max_errors) {
       FT max_se_threshold = std::pow(max_error_threshold_value, 2);
-      std::set<face_descriptor> extended_faces;
+      Face_set extended_faces;
       extend_faces(one_ring_faces, np.stencil_ring_size, &extended_faces);
       for (it = extended_faces.begin(); it != extended_faces.end(); ++it) {
         face_descriptor fd = *it;
@@ -3386,6 +4117,7 @@ class Mesh_properties {
 
   void add_circulator_degenerate_faces(vertex_descriptor vd,
     FT radian_threshold, DPQueue_face_long *queue) const {
+    FT cosine_threshold = std::cos(radian_threshold);
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     FT longest_squared_length = 0.0;
     do {
@@ -3393,8 +4125,8 @@ class Mesh_properties {
       if (!is_border(hd)) {
         face_descriptor fd = get_face(hd);
         halfedge_descriptor shortest_hd = get_shortest_halfedge(fd);
-        FT smallest_radian = calculate_opposite_radian(shortest_hd);
-        if (smallest_radian < radian_threshold) {
+        FT largest_cosine = calculate_opposite_cosine(shortest_hd);
+        if (largest_cosine > cosine_threshold) {
           // degenerate edge (we want to make degenerate edge first)
           if (squared_length(shortest_hd) < SQUARED_MIN_VALUE) {
             queue->insert(Face_long(fd, MAX_VALUE));
@@ -3408,6 +4140,56 @@ class Mesh_properties {
     } while (hb != he);
   }
 
+  // 5.4) bulk construction
+  void fill_large_error_queue(FT max_error_threshold_value,
+    DPQueue_halfedge_long *large_error_queue) const {
+    FT max_se_threshold = std::pow(max_error_threshold_value, 2);
+    std::vector<face_descriptor> faces(mesh_.faces().begin(),
+      mesh_.faces().end());
+    // get_longest_halfedge() only fills the geometry cache of its own face
+    fill_queue_in_bulk(faces, [this, max_se_threshold](face_descriptor fd,
+      halfedge_descriptor *key, FT *priority) {
+      FT max_se = get_face_max_squared_error(fd);
+      if (max_se < max_se_threshold) {
+        return false;
+      }
+      *key = get_longest_halfedge(fd);
+      *priority = max_se;
+      return true;
+    }, large_error_queue);
+  }
+
+  template <typename Element, typename Function, typename Queue>
+  void fill_queue_in_bulk(const std::vector<Element> &elements,
+    const Function &key_of, Queue *queue) const {
+    // key_of(element, &key, &priority) returns false to filter the element;
+    // it must only read the mesh, as the keys are computed in parallel
+    typedef typename Queue::left_key_type Key;
+    std::vector<std::pair<Key, FT>> entries(elements.size());
+    std::vector<char> kept(elements.size(), 0);
+#ifdef CGAL_LINKED_WITH_TBB
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, elements.size()),
+      [&](const tbb::blocked_range<std::size_t> &range) {
+      for (std::size_t i = range.begin(); i != range.end(); ++i) {
+        kept[i] = key_of(elements[i], &entries[i].first, &entries[i].second);
+      }
+    });
+#else
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+      kept[i] = key_of(elements[i], &entries[i].first, &entries[i].second);
+    }
+#endif
+    // the elements come in index order, so hinting at the end of the
+    // descriptor index makes most insertions there amortized constant; ties
+    // in priority keep the scan order, as with one-by-one insertion
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      if (kept[i]) {
+        queue->left.insert(queue->left.end(), typename Queue::left_value_type(
+          entries[i].first, entries[i].second));
+      }
+    }
+  }
+
   // 6) local operations
 
   // 6.1) split
@@ -3422,21 +4204,30 @@ class Mesh_properties {
     reset_halfedge_properties(hnew, hd);
     reset_halfedge_properties(get_opposite(hnew), get_opposite(hd));
     reset_vertex_properties(vd, get_null_vertex());
+    // the halves of a split face inherit its max error
     if (!is_border(hnew)) {
+      FT max_se = get_face_max_squared_error(get_face(hnew));
       h = CGAL::Euler::split_face(hnew, mesh_.next(hd), mesh_);
       reset_halfedge_properties(h, get_null_halfedge());
       reset_halfedge_properties(get_opposite(h), get_null_halfedge());
       reset_face_properties(get_face(h), get_null_face());
       reset_face_properties(get_face(get_opposite(h)), get_null_face());
+      set_face_max_squared_error(get_face(h), max_se);
+      set_face_max_squared_error(get_face(get_opposite(h)), max_se);
     }
     if (!is_border(get_opposite(hnew))) {
+      FT max_se = get_face_max_squared_error(get_face(get_opposite(hnew)));
       h = CGAL::Euler::split_face(mesh_.next(get_opposite(hnew)),
         get_opposite(hd), mesh_);
       reset_halfedge_properties(h, get_null_halfedge());
       reset_halfedge_properties(get_opposite(h), get_null_halfedge());
       reset_face_properties(get_face(h), get_null_face());
       reset_face_properties(get_face(get_opposite(h)), get_null_face());
+      set_face_max_squared_error(get_face(h), max_se);
+      set_face_max_squared_error(get_face(get_opposite(h)), max_se);
     }
+    invalidate_face_geometries(vd);   // the split faces kept their handles
+    mark_one_ring_modified(vd);
     return hnew;
   }
 
@@ -3446,8 +4237,10 @@ class Mesh_properties {
     // 1) apply the local operator(s)
     // 2) update property maps of new generated faces, halfedges and vertices
     edge_descriptor ed = mesh_.edge(hd);
+    mark_one_ring_modified(get_source_vertex(hd));  // with the removed ones
+    mark_one_ring_modified(get_target_vertex(hd));
     vertex_descriptor vd = CGAL::Euler::collapse_edge(ed, mesh_);
-    get_point(vd) = new_point;
+    set_vertex_point(vd, new_point);
     // since no new elements added, we only reset the sample links
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
@@ -3581,13 +4374,14 @@ class Mesh_properties {
     const Point &q = get_point(get_target_vertex(hd));
     const Point &s = get_point(get_opposite_vertex(hd));
     const Point &t = get_point(get_opposite_vertex(get_opposite(hd)));
-    FT min_radian_before = calculate_smallest_radian(p, q, s);
-    min_radian_before = CGAL::min(min_radian_before,
-      calculate_smallest_radian(q, p, t));
-    FT min_radian_after = calculate_smallest_radian(t, s, p);
-    min_radian_after = CGAL::min(min_radian_after,
-      calculate_smallest_radian(s, t, q));
-    return min_radian_before < min_radian_after;
+    // a smaller minimal radian means a larger maximal cosine
+    FT max_cosine_before = calculate_largest_cosine(p, q, s);
+    max_cosine_before = CGAL::max(max_cosine_before,
+      calculate_largest_cosine(q, p, t));
+    FT max_cosine_after = calculate_largest_cosine(t, s, p);
+    max_cosine_after = CGAL::max(max_cosine_after,
+      calculate_largest_cosine(s, t, q));
+    return max_cosine_before > max_cosine_after;
   }
 
   void flip_inner_edge(halfedge_descriptor hd) {
@@ -3599,6 +4393,11 @@ class Mesh_properties {
     clear_halfedge_links(get_opposite(hd));
     clear_face_links(get_face(hd));
     clear_face_links(get_face(get_opposite(hd)));
+    invalidate_face_geometry(get_face(hd));
+    invalidate_face_geometry(get_face(get_opposite(hd)));
+    mark_face_modified(get_face(hd));
+    mark_face_modified(get_face(get_opposite(hd)));
+    mark_edge_modified(mesh_.edge(hd));
   }
 
   int flip_edges(const Face_tree &input_face_tree,
@@ -3628,8 +4427,8 @@ class Mesh_properties {
         const Point &start_point = get_point(get_opposite_vertex(*hb));
         const Point &end_point = get_point(get_source_vertex(*hb));
         const Point &old_point = get_point(get_target_vertex(*hb));
-        FT radian = calculate_radian(end_point, old_point, start_point);
-        if (radian < MIN_VALUE || CGAL_PI - radian < MIN_VALUE) {
+        FT cosine = calculate_cosine(end_point, old_point, start_point);
+        if (cosine > COS_MIN_VALUE || cosine < -COS_MIN_VALUE) {
           return true;    // degenerate case
         }
         Plane plane(end_point, old_point, start_point);
@@ -3646,7 +4445,7 @@ class Mesh_properties {
   void relocate_vertex_point(vertex_descriptor vd, const Point &new_point) {
     // 1) apply the local operator(s)
     // 2) update property maps of new generated faces, halfedges and vertices
-    get_point(vd) = new_point;
+    set_vertex_point(vd, new_point);
     // since no new element added, we only clear the links
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
@@ -3665,7 +4464,7 @@ class Mesh_properties {
     FT max_error_threshold_value, FT max_error, FT min_radian,
     bool reduce_complexity, DPQueue_halfedge_long *large_error_queue,
     DPQueue_halfedge_short *small_radian_queue,
-    const std::set<vertex_descriptor> &vertices, const NamedParameters &np) {
+    const Vertex_set &vertices, const NamedParameters &np) {
     // step 1: construct the vertex_map to make bigger distance relocate first
     std::map<FT, vertex_descriptor> vertex_map;
     for (auto it = vertices.begin(); it != vertices.end(); ++it) {
@@ -3698,8 +4497,8 @@ class Mesh_properties {
     do {
       // vertex out links
       if (use_vertex_out_links) {
-        const Point &out_start = get_vertex_out_link(vd).second.first;
-        const Point &out_end = get_vertex_out_link(vd).second.second;
+        const Point &out_start = to_point(get_vertex_out_link(vd).second.first);
+        const Point &out_end = to_point(get_vertex_out_link(vd).second.second);
         weight = CGAL::sqrt(CGAL::squared_distance(out_start, out_end));
         if (use_feature_intensity_weights) {
           weight *= get_vertex_out_link(vd).first;
@@ -3720,8 +4519,8 @@ class Mesh_properties {
           const Link_list &edge_out_links = get_halfedge_out_links(hd);
           for (auto it = edge_out_links.begin();
             it != edge_out_links.end(); ++it) {
-            const Point &out_start = it->second.first;
-            const Point &out_end = it->second.second;
+            const Point &out_start = to_point(it->second.first);
+            const Point &out_end = to_point(it->second.second);
             weight = CGAL::sqrt(CGAL::squared_distance(out_start, out_end));
             if (use_feature_intensity_weights) {
               weight *= it->first;
@@ -3753,8 +4552,8 @@ class Mesh_properties {
         const Link_list &face_out_links = get_face_out_links(fd);
         for (auto it = face_out_links.begin();
           it != face_out_links.end(); ++it) {
-          const Point &out_start = it->second.first;
-          const Point &out_end = it->second.second;
+          const Point &out_start = to_point(it->second.first);
+          const Point &out_end = to_point(it->second.second);
           weight = CGAL::sqrt(CGAL::squared_distance(out_start, out_end));
           if (use_feature_intensity_weights) {
             weight *= it->first;
@@ -3774,8 +4573,8 @@ class Mesh_properties {
         for (auto it = vertex_in_links.begin();
           it != vertex_in_links.end(); ++it) {
           Link *link = *it;
-          const Point &in_start = link->second.first;
-          const Point &in_end = link->second.second;
+          const Point &in_start = to_point(link->second.first);
+          const Point &in_end = to_point(link->second.second);
           weight = CGAL::sqrt(CGAL::squared_distance(in_start, in_end));
           if (use_feature_intensity_weights) {
             weight *= link->first;
@@ -3795,8 +4594,8 @@ class Mesh_properties {
         for (auto it = edge_in_links.begin();
           it != edge_in_links.end(); ++it) {
           Link_list_const_iter lit = *it;
-          const Point &in_start = lit->second.first;
-          const Point &in_end = lit->second.second;
+          const Point &in_start = to_point(lit->second.first);
+          const Point &in_end = to_point(lit->second.second);
           weight = CGAL::sqrt(CGAL::squared_distance(in_start, in_end));
           if (use_feature_intensity_weights) {
             weight *= lit->first;
@@ -3816,8 +4615,8 @@ class Mesh_properties {
         for (auto it = face_in_links.begin();
           it != face_in_links.end(); ++it) {
           Link_list_const_iter lit = *it;
-          const Point &in_start = lit->second.first;
-          const Point &in_end = lit->second.second;
+          const Point &in_start = to_point(lit->second.first);
+          const Point &in_end = to_point(lit->second.second);
           weight = CGAL::sqrt(CGAL::squared_distance(in_start, in_end));
           if (use_feature_intensity_weights) {
             weight *= lit->first;
@@ -3895,12 +4694,12 @@ class Mesh_properties {
       }
       ++hb;
     } while (hb != he);
-    Point &p = get_point(vd);
     if (nb_out_links == 0 || nb_in_links == 0) {
-      p = barycenter(vd, np);
+      set_vertex_point(vd, barycenter(vd, np));
       return false;   // the area is too small
     }
     // step 2: calculate the optimized position
+    Point p = get_point(vd);
     Point new_point = calculate_optimized_position(vd, np);
     if (CGAL::squared_distance(new_point, p) < SQUARED_MIN_VALUE) {
       return false;   // the optimization is too little
@@ -3917,127 +4716,72 @@ class Mesh_properties {
     if (np.optimize_strategy == OptimizeStrategy::k_Interpolation) {
       p = input_face_tree.closest_point(p);
     }
+    set_vertex_point(vd, p);
     return true;
   }
 
   // 7) max errors
-  void reset_face_max_squared_errors(FT value) {
-    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-      fi != mesh_.faces().end(); ++fi) {
-      set_face_max_squared_error(*fi, value);
-    }
-  }
-
-  void update_face_in_max_squared_errors() {
-    FT se = 0.0;    // squared error
-    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-      fi != mesh_.faces().end(); ++fi) {
-      Link_iter_list &face_in_links = get_face_in_links(*fi);
-      for (Link_iter_list_iter it = face_in_links.begin();
-        it != face_in_links.end(); ++it) {
-        Link_list_iter llit = *it;
-        const Link &link = *llit;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        set_face_max_squared_error(*fi, CGAL::max(get_face_max_error(*fi), se));
-      }
-    }
-  }
-
-  void update_face_out_max_squared_errors() {
-    FT se = 0.0;    // squared error
-    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-      fi != mesh_.faces().end(); ++fi) {
-      Link_list &face_out_links = get_face_out_links(*fi);
-      for (Link_list_iter it = face_out_links.begin();
-        it != face_out_links.end(); ++it) {
-        const Link &link = *it;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        set_face_max_squared_error(*fi,
-                                   CGAL::max(get_face_max_error(*fi), se));
-      }
+  FT calculate_face_max_squared_error(face_descriptor fd,
+    Squared_length_buffer *buffer) const {
+    // step 1: gather the link vectors of all links related to fd
+    buffer->clear();
+    // face in links
+    const Link_iter_list &face_in_links = get_face_in_links(fd);
+    for (Link_iter_list_const_iter it = face_in_links.begin();
+      it != face_in_links.end(); ++it) {
+      add_link_vector(**it, buffer);
+    }
+    // edge in links
+    const Link_iter_list &edge_in_links = get_edge_in_links(fd);
+    for (Link_iter_list_const_iter it = edge_in_links.begin();
+      it != edge_in_links.end(); ++it) {
+      add_link_vector(**it, buffer);
+    }
+    // vertex in links
+    const Link_pointer_list &vertex_in_links = get_vertex_in_links(fd);
+    for (Link_pointer_const_iter it = vertex_in_links.begin();
+      it != vertex_in_links.end(); ++it) {
+      add_link_vector(**it, buffer);
     }
-  }
-
-  void update_edge_in_max_squared_errors() {
-    FT max_se = 0, se = 0.0;
-    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-      fi != mesh_.faces().end(); ++fi) {
-      Link_iter_list &edge_in_links = get_edge_in_links(*fi);
-      for (Link_iter_list_iter it = edge_in_links.begin();
-        it != edge_in_links.end(); ++it) {
-        Link_list_iter llit = *it;
-        const Link &link = *llit;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(get_face_max_squared_error(*fi), se);
-        set_face_max_squared_error(*fi, max_se);
-      }
+    // face out links
+    const Link_list &face_out_links = get_face_out_links(fd);
+    for (Link_list_const_iter it = face_out_links.begin();
+      it != face_out_links.end(); ++it) {
+      add_link_vector(*it, buffer);
     }
-  }
-
-  void update_edge_out_max_squared_errors() {
-    FT se = 0.0;
-    for (typename Mesh::Edge_range::const_iterator ei = mesh_.edges().begin();
-      ei != mesh_.edges().end(); ++ei) {
-      halfedge_descriptor hd = mesh_.halfedge(*ei);
-      if (get_halfedge_normal_dihedral(hd) == -1.0) {
-        hd = get_opposite(hd);
+    halfedge_descriptor hd = mesh_.halfedge(fd);
+    for (int i = 0; i <= 2; ++i) {
+      // edge out links
+      halfedge_descriptor hi = hd;
+      if (get_halfedge_normal_dihedral(hi) == -1.0) {
+        hi = get_opposite(hi);
       }
-      FT max_se = 0.0;
-      Link_list &edge_out_links = get_halfedge_out_links(hd);
-      for (Link_list_iter it = edge_out_links.begin();
+      const Link_list &edge_out_links = get_halfedge_out_links(hi);
+      for (Link_list_const_iter it = edge_out_links.begin();
         it != edge_out_links.end(); ++it) {
-        const Link &link = *it;
-        se = CGAL::squared_distance(link.second.first, link.second.second);
-        max_se = CGAL::max(max_se, se);
-      }
-      face_descriptor fd = get_face(hd);
-      set_face_max_squared_error(fd,
-          CGAL::max(get_face_max_squared_error(fd), max_se));
-      if (!is_border(get_opposite(hd))) {
-        fd = get_face(get_opposite(hd));
-        set_face_max_squared_error(fd,
-            CGAL::max(get_face_max_squared_error(fd), max_se));
-      }
-    }
-  }
-
-  void update_vertex_in_max_squared_errors() {
-    FT se = 0.0;
-    for (typename Mesh::Face_range::const_iterator fi = mesh_.faces().begin();
-      fi != mesh_.faces().end(); ++fi) {
-      Link_pointer_list &vertex_in_links = get_vertex_in_links(*fi);
-      for (Link_pointer_iter it = vertex_in_links.begin();
-        it != vertex_in_links.end(); ++it) {
-        Link *link = *it;
-        se = CGAL::squared_distance(link->second.first, link->second.second);
-        set_face_max_squared_error(*fi,
-            CGAL::max(get_face_max_squared_error(*fi), se));
+        add_link_vector(*it, buffer);
       }
+      // vertex out links
+      add_link_vector(get_vertex_out_link(mesh_.target(hd)), buffer);
+      hd = mesh_.next(hd);
     }
+    // step 2: reduce the squared lengths in bulk
+    return buffer->max();
   }
 
-  void update_vertex_out_max_squared_errors() {
-    FT se = 0.0;
-    for (typename Mesh::Vertex_range::const_iterator vi = mesh_.vertices().begin();
-      vi != mesh_.vertices().end(); ++vi) {
-      const Link &link = get_vertex_out_link(*vi);
-      se = CGAL::squared_distance(link.second.first, link.second.second);
-      Face_around_target_circulator fb(mesh_.halfedge(*vi), mesh_), fe(fb);
-      do {
-        if (*fb != get_null_face()) {
-          set_face_max_squared_error(*fb,
-              CGAL::max(get_face_max_squared_error(*fb), se));
-        }
-        ++fb;
-      } while (fb != fe);
-    }
+  void add_link_vector(const Link &link,
+    Squared_length_buffer *buffer) const {
+    const Point &p = to_point(link.second.first);
+    const Point &q = to_point(link.second.second);
+    buffer->add(CGAL::to_double(p.x() - q.x()),
+      CGAL::to_double(p.y() - q.y()), CGAL::to_double(p.z() - q.z()));
   }
 
   // 8) collections
 
   // vertex_descriptor collection
-  void collect_vertices(const std::set<face_descriptor> &faces,
-    std::set<vertex_descriptor> *vertices) const {
+  void collect_vertices(const Face_set &faces,
+    Vertex_set *vertices) const {
     for (auto it = faces.begin(); it != faces.end(); ++it) {
       halfedge_descriptor hd = mesh_.halfedge(*it);
       vertices->insert(get_target_vertex(hd));
@@ -4047,7 +4791,7 @@ class Mesh_properties {
   }
 
   void collect_incident_vertices(vertex_descriptor vd,
-    std::set<vertex_descriptor> *vertices) const {
+    Vertex_set *vertices) const {
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
       vertices->insert(get_source_vertex(*hb));
@@ -4103,7 +4847,7 @@ class Mesh_properties {
 
   // face_descriptor collection
   void collect_one_ring_faces_incident_to_vertex(vertex_descriptor vd,
-    std::set<face_descriptor> *faces) const {
+    Face_set *faces) const {
     Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
     do {
       if (!is_border(*hb)) {
@@ -4124,7 +4868,7 @@ class Mesh_properties {
   }
 
   void collect_faces_incident_to_edge(halfedge_descriptor hd,
-    std::set<face_descriptor> *faces) const {
+    Face_set *faces) const {
     if (!is_border(hd)) {
       faces->insert(get_face(hd));
     }
@@ -4144,16 +4888,29 @@ class Mesh_properties {
     } while (hb != he);
   }
 
-  void extend_faces_by_one_ring(std::set<face_descriptor> *faces) const {
-    std::set<vertex_descriptor> vertices;
-    collect_vertices(*faces, &vertices);
-    for (auto it = vertices.begin(); it != vertices.end(); ++it) {
-      collect_one_ring_faces_incident_to_vertex(*it, faces);
+  void extend_faces_by_one_ring(Face_set *faces) const {
+    Face_set seeds;
+    seeds.swap(*faces);
+    extend_faces(seeds, 1, faces);
+  }
+
+  unsigned int next_visit_epoch() const {
+    if (++visit_epoch_ == 0) {    // wrapped around, clear the old stamps
+      for (typename Mesh::Face_range::const_iterator fi =
+        mesh_.faces().begin(); fi != mesh_.faces().end(); ++fi) {
+        put(face_visit_epochs_, *fi, 0);
+      }
+      for (typename Mesh::Vertex_range::const_iterator vi =
+        mesh_.vertices().begin(); vi != mesh_.vertices().end(); ++vi) {
+        put(vertex_visit_epochs_, *vi, 0);
+      }
+      visit_epoch_ = 1;
     }
+    return visit_epoch_;
   }
 
   void collect_incident_faces(face_descriptor fd,
-    std::set<face_descriptor> *faces) const {
+    Face_set *faces) const {
     halfedge_descriptor hd = mesh_.halfedge(fd);
     // the first vertex
     vertex_descriptor vd1 = get_target_vertex(hd);
@@ -4298,6 +5055,52 @@ class Mesh_properties {
     }
   }
 
+  void mark_face_modified(face_descriptor fd) {
+    if (!all_elements_modified_) {
+      modified_faces_.push_back(fd);
+      limit_modified_elements();
+    }
+  }
+
+  void mark_edge_modified(edge_descriptor ed) {
+    if (!all_elements_modified_) {
+      modified_edges_.push_back(ed);
+      limit_modified_elements();
+    }
+  }
+
+  void mark_one_ring_modified(vertex_descriptor vd) {
+    // the vertex, its incident faces and its incident edges
+    if (all_elements_modified_) {
+      return;
+    }
+    modified_vertices_.push_back(vd);
+    Halfedge_around_target_circulator hb(mesh_.halfedge(vd), mesh_), he(hb);
+    do {
+      if (!is_border(*hb)) {
+        modified_faces_.push_back(get_face(*hb));
+      }
+      modified_edges_.push_back(mesh_.edge(*hb));
+      ++hb;
+    } while (hb != he);
+    limit_modified_elements();
+  }
+
+  void mark_all_elements_modified() {
+    clear_modified_elements();
+    all_elements_modified_ = true;
+  }
+
+  void limit_modified_elements() {
+    // if nobody clears them (e.g. the viewer is hidden), the lists would
+    // grow with every operation; beyond the mesh size all is modified
+    if (modified_faces_.size() > mesh_.num_faces() ||
+        modified_edges_.size() > mesh_.num_edges() ||
+        modified_vertices_.size() > mesh_.num_vertices()) {
+      mark_all_elements_modified();
+    }
+  }
+
   void reset_face_properties(face_descriptor fd, face_descriptor fd_source) {
     // step 1: reset the basic properties
     if (fd_source == get_null_face()) {
@@ -4309,6 +5112,7 @@ class Mesh_properties {
       set_face_normal(fd, get_face_normal(fd_source));
       set_face_max_squared_error(fd, get_face_max_squared_error(fd_source));
     }
+    invalidate_face_geometry(fd);
     // step 2: reset the sample links
     clear_face_links(fd);
   }
@@ -4442,8 +5246,8 @@ class Mesh_properties {
       for (Link_iter_list_const_iter cit = face_in_links.begin();
         cit != face_in_links.end(); ++cit) {
         Link_list_const_iter llcit = *cit;
-        const Point &start = llcit->second.first;
-        const Point &end = llcit->second.second;
+        const Point &start = to_point(llcit->second.first);
+        const Point &end = to_point(llcit->second.second);
         rms_distance += CGAL::squared_distance(start, end);
       }
       nb_samples += face_in_links.size();
@@ -4452,8 +5256,8 @@ class Mesh_properties {
       for (Link_iter_list_const_iter cit = edge_in_links.begin();
         cit != edge_in_links.end(); ++cit) {
         Link_list_const_iter llcit = *cit;
-        const Point &start = llcit->second.first;
-        const Point &end = llcit->second.second;
+        const Point &start = to_point(llcit->second.first);
+        const Point &end = to_point(llcit->second.second);
         rms_distance += CGAL::squared_distance(start, end);
       }
       nb_samples += edge_in_links.size();
@@ -4462,8 +5266,8 @@ class Mesh_properties {
       for (Link_pointer_const_iter cit = vertex_in_links.begin();
         cit != vertex_in_links.end(); ++cit) {
         const Link *link = *cit;
-        const Point &start = link->second.first;
-        const Point &end = link->second.second;
+        const Point &start = to_point(link->second.first);
+        const Point &end = to_point(link->second.second);
         rms_distance += CGAL::squared_distance(start, end);
       }
       nb_samples += vertex_in_links.size();
@@ -4475,8 +5279,8 @@ class Mesh_properties {
       for (Link_list_const_iter cit = face_out_links.begin();
         cit != face_out_links.end(); ++cit) {
         const Link &link = *cit;
-        const Point &start = link.second.first;
-        const Point &end = link.second.second;
+        const Point &start = to_point(link.second.first);
+        const Point &end = to_point(link.second.second);
         rms_distance += CGAL::squared_distance(start, end);
       }
       nb_samples += face_out_links.size();
@@ -4492,8 +5296,8 @@ class Mesh_properties {
       for (Link_list_const_iter cit = edge_out_links.begin();
         cit != edge_out_links.end(); ++cit) {
         const Link &link = *cit;
-        const Point &start = link.second.first;
-        const Point &end = link.second.second;
+        const Point &start = to_point(link.second.first);
+        const Point &end = to_point(link.second.second);
         rms_distance += CGAL::squared_distance(start, end);
       }
       nb_samples += edge_out_links.size();
@@ -4502,8 +5306,8 @@ class Mesh_properties {
     for (typename Mesh::Vertex_range::const_iterator vi = mesh_.vertices().begin();
       vi != mesh_.vertices().end(); ++vi) {
       const Link &link = get_vertex_out_link(*vi);
-      const Point &start = link.second.first;
-      const Point &end = link.second.second;
+      const Point &start = to_point(link.second.first);
+      const Point &end = to_point(link.second.second);
       rms_distance += CGAL::squared_distance(start, end);
     }
     nb_samples += mesh_.number_of_vertices();
@@ -4664,24 +5468,68 @@ class Mesh_properties {
 
   // 13) utilities
   Point_and_primitive_id get_closest_point_and_primitive(
-      const std::set<face_descriptor> &in_link_faces,
+      const Face_set &in_link_faces,
       const Point &point) const {
     // find the closest point in the face set
+    Triangle_batch batch;
+    std::vector<face_descriptor> batch_faces;
+    fill_triangle_batch(in_link_faces, &batch, &batch_faces);
+    return get_closest_point_and_primitive(batch, batch_faces, point);
+  }
+
+  Point_and_primitive_id get_closest_point_and_primitive(
+      const Triangle_batch &batch,
+      const std::vector<face_descriptor> &batch_faces,
+      const Point &point) const {
     Point_and_primitive_id pp;
-    FT min_sd = DOUBLE_MAX;
-    Point nearest_point;
-    for (auto it = in_link_faces.begin(); it != in_link_faces.end(); ++it) {
-      face_descriptor fd = *it;
-      FT sd = squared_distance(point, fd, &nearest_point);
-      if (sd < min_sd) {
-        pp.first = nearest_point;
-        pp.second = fd;
-        min_sd = sd;
-      }
+    double x = 0.0, y = 0.0, z = 0.0, sd = 0.0;
+    int index = batch.closest(CGAL::to_double(point.x()),
+      CGAL::to_double(point.y()), CGAL::to_double(point.z()), &x, &y, &z, &sd);
+    if (index >= 0) {
+      pp.first = Point(x, y, z);
+      pp.second = batch_faces[index];
     }
     return pp;
   }
 
+  void fill_triangle_batch(const Face_set &faces,
+      Triangle_batch *batch, std::vector<face_descriptor> *batch_faces) const {
+    // same vertex order as squared_distance(p, fd, nearest_point)
+    batch->clear();
+    batch->reserve(faces.size());
+    batch_faces->clear();
+    batch_faces->reserve(faces.size());
+    for (auto it = faces.begin(); it != faces.end(); ++it) {
+      halfedge_descriptor hd = mesh_.halfedge(*it);
+      const Point &a = get_point(get_target_vertex(hd));
+      const Point &b = get_point(get_opposite_vertex(hd));
+      const Point &c = get_point(get_source_vertex(hd));
+      batch->add(CGAL::to_double(a.x()), CGAL::to_double(a.y()),
+        CGAL::to_double(a.z()), CGAL::to_double(b.x()),
+        CGAL::to_double(b.y()), CGAL::to_double(b.z()),
+        CGAL::to_double(c.x()), CGAL::to_double(c.y()),
+        CGAL::to_double(c.z()));
+      batch_faces->push_back(*it);
+    }
+  }
+
+  static bool in_link_lower_bound_exceeds(const Triangle_batch &untouched,
+      const Triangle_batch &fan, const Point &p, FT slack,
+      FT squared_threshold) {
+    double px = CGAL::to_double(p.x()), py = CGAL::to_double(p.y());
+    double pz = CGAL::to_double(p.z());
+    double qx, qy, qz, sd;
+    if (untouched.closest(px, py, pz, &qx, &qy, &qz, &sd) != -1 &&
+      sd <= squared_threshold) {
+      return false;   // may stay bound to an untouched face
+    }
+    if (fan.closest(px, py, pz, &qx, &qy, &qz, &sd) == -1) {
+      return false;
+    }
+    FT d = CGAL::sqrt(sd) - slack;
+    return d > 0.0 && d * d > squared_threshold;
+  }
+
   FT squared_distance(const Point &p, face_descriptor fd,
     Point *nearest_point) const {
     halfedge_descriptor hd = mesh_.halfedge(fd);
@@ -4712,7 +5560,19 @@ class Mesh_properties {
  private:
   Mesh &mesh_;
 
+  bool use_face_geometry_cache_;
+  mutable unsigned int visit_epoch_;            // stamp of extend_faces
+  FT max_squared_error_threshold_;              // 0 if the errors are unused
+  bool max_squared_errors_measured_;            // false before the first pass
+  Point link_origin_;                           // see Compact_point
+  bool all_elements_modified_;                  // modified elements
+  std::vector<face_descriptor> modified_faces_;
+  std::vector<edge_descriptor> modified_edges_;
+  std::vector<vertex_descriptor> modified_vertices_;
+
   Face_tags face_tags_;                         // face related properties
+  mutable Face_epochs face_visit_epochs_;
+  mutable Face_geometries face_geometries_;     // filled lazily by the getters
   Face_normals face_normals_;
   Face_max_errors face_max_squared_errors_;
   Face_link_list face_out_links_;
@@ -4726,6 +5586,7 @@ class Mesh_properties {
   Halfedge_link_list halfedge_out_links_;
 
   Vertex_tags vertex_tags_;                     // vertex related properties
+  mutable Vertex_epochs vertex_visit_epochs_;
   Vertex_max_dihedral vertex_max_dihedrals_;
   Vertex_gaussian_curvature vertex_gaussian_curvatures_;
   Vertex_link vertex_out_link_;
@@ -23,14 +23,18 @@
 #define SRC_INTERNAL_MINANGLE_REMESHING_MINANGLE_REMESH_IMPL_H_
 
 // C/C++
+#include <cmath>
 #include <list>
 #include <set>
 #include <map>
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <utility>
+#include <vector>
 // local
 #include "mesh_properties.h"
+#include "visit_table.h"
 
 namespace CGAL {
 namespace Polygon_mesh_processing {
@@ -47,6 +51,7 @@ class Minangle_remesher {
   typedef typename Mesh_properties_::Normal Normal;
   typedef typename Mesh_properties_::Point Point;
   typedef typename Mesh_properties_::Point_Comp Point_Comp;
+  typedef typename Mesh_properties_::Link_point Link_point;
   typedef typename Mesh_properties_::Point_pair Point_pair;
   typedef typename Mesh_properties_::Bbox Bbox;
   typedef typename Mesh_properties_::Mesh Mesh;
@@ -68,6 +73,9 @@ class Minangle_remesher {
   typedef typename Mesh_properties_::Face_list Face_list;
   typedef typename Mesh_properties_::Face_iter Face_iter;
   typedef typename Mesh_properties_::Face_const_iter Face_const_iter;
+  // element set
+  typedef typename Mesh_properties_::Vertex_set Vertex_set;
+  typedef typename Mesh_properties_::Face_set Face_set;
   // sample links
   typedef typename Mesh_properties_::Link Link;
   typedef typename Mesh_properties_::Link_list Link_list;
@@ -91,6 +99,9 @@ class Minangle_remesher {
   typedef typename Mesh_properties_::Color_const_iter Color_const_iter;
   // AABB tree
   typedef typename Mesh_properties_::Face_tree Face_tree;
+  // Memory report
+  typedef typename Mesh_properties_::Memory_item Memory_item;
+  typedef typename Mesh_properties_::Memory_report Memory_report;
   // Dynamic priority queues
   typedef typename Mesh_properties_::DPQueue_halfedge_long
                                      DPQueue_halfedge_long;
@@ -106,9 +117,23 @@ class Minangle_remesher {
   typedef typename Mesh_properties_::Face_long Face_long;
   typedef typename Mesh_properties_::DPQueue_face_short DPQueue_face_short;
   typedef typename Mesh_properties_::Face_short Face_short;
-  // Visit list and iterator
-  typedef std::list<std::pair<Point, FT>> Visit_list;
-  typedef typename std::list<std::pair<Point, FT>>::iterator Visit_iter;
+  // Visit table (recently collapsed edges)
+  typedef Lru_visit_table Visit_table;
+  typedef typename Visit_table::Key Visit_key;
+  // Progress callback, called between two local operations (the remesh is
+  // consistent then). Returning false cancels the running operation
+  typedef std::function<bool()> Progress_callback;
+  // Collapse candidate (everything needed to simulate and commit a collapse)
+  struct Collapse_candidate {
+    halfedge_descriptor hd;
+    Halfedge_list halfedges;
+    Point new_point;
+    Face_set one_ring_faces, extended_faces;
+    Link_iter_list face_in_links, edge_in_links;
+    Link_pointer_list vertex_in_links;
+    Point_list face_in_end_points, edge_in_end_points, vertex_in_end_points;
+    FT error, radian;
+  };
 
  public:
   // 1) life cycles
@@ -130,12 +155,17 @@ class Minangle_remesher {
     np_.verbose_progress = true;
     np_.apply_initial_mesh_simplification = true;
     np_.apply_final_vertex_relocation = true;
+    np_.use_face_geometry_cache = true;
+    np_.collapse_batch_size = 1;
+    np_.reorder_elements = false;
+    np_.max_garbage_ratio = 0.25;
     // sample parameters
     np_.samples_per_face_in = 10;
     np_.samples_per_face_out = 10;
     np_.max_samples_per_area = 10000;
     np_.min_samples_per_triangle = 1;
     np_.bvd_iteration_count = 1;
+    np_.sampling_thread_count = 0;
     np_.sample_number_strategy = SampleNumberStrategy::k_fixed;
     np_.sample_strategy = SampleStrategy::k_adaptive;
     np_.use_stratified_sampling = false;
@@ -163,7 +193,11 @@ class Minangle_remesher {
     input_bbox = Bbox(DOUBLE_MAX, DOUBLE_MAX, DOUBLE_MAX,
                       DOUBLE_MIN, DOUBLE_MIN, DOUBLE_MIN);
     links_initialized_ = false;
+    links_generation_ = 0;
     input_aabb_tree_constructed_ = false;
+    cancelled_ = false;
+    nb_collapse_simulations_ = 0;
+    nb_collapse_simulations_skipped_ = 0;
   }
 
   explicit Minangle_remesher(const NamedParameters &np) {
@@ -174,7 +208,11 @@ class Minangle_remesher {
     input_bbox = Bbox(DOUBLE_MAX, DOUBLE_MAX, DOUBLE_MAX,
                       DOUBLE_MIN, DOUBLE_MIN, DOUBLE_MIN);
     links_initialized_ = false;
+    links_generation_ = 0;
     input_aabb_tree_constructed_ = false;
+    cancelled_ = false;
+    nb_collapse_simulations_ = 0;
+    nb_collapse_simulations_skipped_ = 0;
   }
 
   virtual ~Minangle_remesher() {
@@ -191,7 +229,10 @@ class Minangle_remesher {
   // 2) parameter access functions
   // 2.1) general parameters
   FT get_max_error_threshold() const { return np_.max_error_threshold; }
-  void set_max_error_threshold(FT value) { np_.max_error_threshold = value; }
+  void set_max_error_threshold(FT value) {
+    np_.max_error_threshold = value;
+    update_max_squared_error_threshold();
+  }
   FT get_min_angle_threshold() const { return np_.min_angle_threshold; }
   void set_min_angle_threshold(FT value) { np_.min_angle_threshold = value; }
   int get_max_mesh_complexity() const { return np_.max_mesh_complexity; }
@@ -236,6 +277,23 @@ class Minangle_remesher {
       { return np_.apply_final_vertex_relocation; }
   void set_apply_final_vertex_relocation(bool value)
       { np_.apply_final_vertex_relocation = value; }
+  int get_collapse_batch_size() const { return np_.collapse_batch_size; }
+  void set_collapse_batch_size(int value) { np_.collapse_batch_size = value; }
+  bool get_reorder_elements() const { return np_.reorder_elements; }
+  void set_reorder_elements(bool value) { np_.reorder_elements = value; }
+  FT get_max_garbage_ratio() const { return np_.max_garbage_ratio; }
+  void set_max_garbage_ratio(FT value) { np_.max_garbage_ratio = value; }
+  bool get_use_face_geometry_cache() const
+      { return np_.use_face_geometry_cache; }
+  void set_use_face_geometry_cache(bool value) {
+    np_.use_face_geometry_cache = value;
+    if (input_ != NULL) {
+      input_->set_use_face_geometry_cache(value);
+    }
+    if (remesh_ != NULL) {
+      remesh_->set_use_face_geometry_cache(value);
+    }
+  }
   // 2.2) sample parameters
   int get_samples_per_face_in() const { return np_.samples_per_face_in; }
   void set_samples_per_face_in(int value) { np_.samples_per_face_in = value; }
@@ -251,6 +309,9 @@ class Minangle_remesher {
       { np_.min_samples_per_triangle = value; }
   int get_bvd_iteration_count() const { return np_.bvd_iteration_count; }
   void set_bvd_iteration_count(int value) { np_.bvd_iteration_count = value; }
+  int get_sampling_thread_count() const { return np_.sampling_thread_count; }
+  void set_sampling_thread_count(int value)
+      { np_.sampling_thread_count = value; }
   SampleNumberStrategy get_sample_number_strategy() const
       { return np_.sample_number_strategy; }
   void set_sample_number_strategy(SampleNumberStrategy value)
@@ -318,11 +379,28 @@ class Minangle_remesher {
   Bbox get_input_bbox() const { return input_bbox; }
   const NamedParameters &get_named_parameters() const { return np_; }
   bool get_links_initialized() const { return links_initialized_; }
+  bool get_cancelled() const { return cancelled_; }
+  // changes whenever the samples or the links may have changed
+  unsigned int get_links_generation() const { return links_generation_; }
+  void set_progress_callback(const Progress_callback &callback)
+      { progress_callback_ = callback; }
   void set_input(Mesh *input, bool verbose_progress) {
     // step 1: set the input
     delete_input();
+    if (np_.reorder_elements) {
+      Mesh_properties_::reorder_along_hilbert_curve(input);
+    }
     input_ = new Mesh_properties_(input);
+    input_->set_use_face_geometry_cache(np_.use_face_geometry_cache);
     input_bbox = input_->calculate_bounding_box();
+    update_max_squared_error_threshold();
+    // the links of both meshes point to each other, so they share the origin
+    input_->set_link_origin(Point((input_bbox.xmin() + input_bbox.xmax()) / 2,
+      (input_bbox.ymin() + input_bbox.ymax()) / 2,
+      (input_bbox.zmin() + input_bbox.zmax()) / 2));
+    if (remesh_ != NULL) {
+      remesh_->set_link_origin(input_->get_link_origin());
+    }
     // step 2: calculate the properties
     calculate_normals(true, verbose_progress);
     // step 3: update feature intensities and clear links
@@ -335,7 +413,15 @@ class Minangle_remesher {
   void set_remesh(Mesh *remesh, bool verbose_progress) {
     // step 1: set the remesh
     delete_remesh();
+    if (np_.reorder_elements) {
+      Mesh_properties_::reorder_along_hilbert_curve(remesh);
+    }
     remesh_ = new Mesh_properties_(remesh);
+    remesh_->set_use_face_geometry_cache(np_.use_face_geometry_cache);
+    if (input_ != NULL) {
+      remesh_->set_link_origin(input_->get_link_origin());
+    }
+    update_max_squared_error_threshold();
     // step 2: calculate the properties
     calculate_normals(false, verbose_progress);
     // step 3: update feature intensities and clear links
@@ -348,12 +434,14 @@ class Minangle_remesher {
       delete input_;
     }
     input_ = NULL;
+    ++links_generation_;
   }
   void delete_remesh() {
     if (remesh_ != NULL) {
       delete remesh_;
     }
     remesh_ = NULL;
+    ++links_generation_;
   }
   void save_remesh_as(const std::string &file_name) const {
     if (remesh_ == NULL) {
@@ -381,10 +469,61 @@ class Minangle_remesher {
       remesh_->trace_properties();
       FT diagonal_length = input_->calculate_diagonal_length();
       remesh_->trace_additional_properties(diagonal_length);
+      trace_memory_usage();
     }
     return status_before != status_after;
   }
 
+  void calculate_memory_usage(Memory_report *report) const {
+    report->clear();
+    // step 1: the meshes, their property maps and links
+    if (input_ != NULL) {
+      input_->calculate_memory_usage("input", report);
+    }
+    if (remesh_ != NULL) {
+      remesh_->calculate_memory_usage("remesh", report);
+    }
+    // step 2: the AABB trees
+    report->push_back(Memory_item("input face tree", input_face_tree_.size(),
+      Mesh_properties_::calculate_face_tree_memory(input_face_tree_)));
+    report->push_back(Memory_item("remesh face tree",
+      remesh_face_tree_.size(),
+      Mesh_properties_::calculate_face_tree_memory(remesh_face_tree_)));
+    // step 3: the priority queues only live during an operation, so their
+    // peak is estimated (two queues holding all the remesh halfedges)
+    std::size_t nb_entries = remesh_ != NULL ?
+      2 * remesh_->get_mesh().number_of_halfedges() : 0;
+    report->push_back(Memory_item("priority queues (estimated peak)",
+      nb_entries,
+      nb_entries * Mesh_properties_::calculate_queue_entry_memory()));
+    // step 4: the collapsed edges table
+    report->push_back(Memory_item("collapsed table", collapsed_table_.size(),
+      collapsed_table_.memory_usage()));
+    // step 5: the nodes held by the scratch pools (in use or free, over all
+    // the threads)
+    report->push_back(Memory_item("scratch pools", Scratch_pool::held_count(),
+      Scratch_pool::held()));
+  }
+
+  void trace_memory_usage() const {
+    Memory_report report;
+    calculate_memory_usage(&report);
+    std::size_t total = 0;
+    std::cout << yellow << "MEMORY USAGE" << white << std::endl;
+    for (std::size_t i = 0; i < report.size(); ++i) {
+      const Memory_item &item = report[i];
+      std::cout << item.name << ": " << item.count << " ("
+        << item.bytes / 1024.0 << " KB)" << std::endl;
+      total += item.bytes;
+    }
+    std::cout << "Total: " << total / (1024.0 * 1024.0) << " MB";
+    if (remesh_ != NULL && remesh_->get_mesh().number_of_faces() > 0) {
+      std::cout << " (" << total / remesh_->get_mesh().number_of_faces()
+        << " bytes per remesh face)";
+    }
+    std::cout << std::endl;
+  }
+
   // 5) max error
   FT get_max_error_threshold_value() const {
     FT diagonal = std::sqrt(std::pow(
@@ -416,6 +555,7 @@ class Minangle_remesher {
       }
     }
     links_initialized_ = false;
+    ++links_generation_;
   }
 
   // 7) sample and links
@@ -446,8 +586,13 @@ class Minangle_remesher {
     input_->generate_out_links(remesh_face_tree_, np_.samples_per_face_in,
       INITIAL_BVD_COUNT, remesh_, np_);
     // step 5: compute the max_squared_errors
+    CGAL::Timer timer;
+    timer.start();
+    std::cout << "Computing max errors...";
     remesh_->calculate_max_squared_errors();
+    std::cout << "Done (" << timer.time() << " s)" << std::endl;
     links_initialized_ = true;
+    Scratch_pool::purge();    // releases the recycled nodes of the operation
   }
 
   // 8) polyhedron manipulations
@@ -466,13 +611,16 @@ class Minangle_remesher {
     CGAL::Timer timer;
     timer.start();
     std::cout << std::endl << "Min angle remeshing..." << std::endl;
+    cancelled_ = false;
     if (np_.apply_initial_mesh_simplification) {
       std::cout << std::endl;
       initial_mesh_simplification();
     }
-    std::cout << std::endl;
-    maximize_minimal_angle();
-    if (np_.apply_final_vertex_relocation) {
+    if (!cancelled_) {
+      std::cout << std::endl;
+      maximize_minimal_angle();
+    }
+    if (np_.apply_final_vertex_relocation && !cancelled_) {
       std::cout << std::endl;
       final_vertex_relocation();
     }
@@ -488,6 +636,7 @@ class Minangle_remesher {
     if (!links_initialized_) {
       generate_samples_and_links();
     }
+    ++links_generation_;
     FT max_error_threshold_value = get_max_error_threshold_value();
     CGAL::Timer timer;
     timer.start();
@@ -501,10 +650,14 @@ class Minangle_remesher {
     unsigned int index = 0, nb_operations = 0;
     halfedge_descriptor max_error_halfedge;
     FT max_error = 0.0;
+    nb_collapse_simulations_ = 0;
+    nb_collapse_simulations_skipped_ = 0;
+    cancelled_ = false;
     while (remesh_->size_of_vertices() < np_.max_mesh_complexity &&
-      (!large_error_queue.empty() || !collapse_candidate_queue.empty())) {
+      (!large_error_queue.empty() || !collapse_candidate_queue.empty()) &&
+      report_progress()) {
       while (remesh_->size_of_vertices() < np_.max_mesh_complexity &&
-        !large_error_queue.empty()) {
+        !large_error_queue.empty() && report_progress()) {
         typename DPQueue_halfedge_long::right_map::iterator eit =
           large_error_queue.right.begin();
         max_error = CGAL::sqrt(eit->first);
@@ -518,7 +671,22 @@ class Minangle_remesher {
           np_.verbose_progress, true, &large_error_queue,
           &collapse_candidate_queue, max_error_halfedge);
       }
-      if (!collapse_candidate_queue.empty()) {
+      if (cancelled_) {
+        break;
+      }
+      if (!collapse_candidate_queue.empty() && np_.collapse_batch_size > 1) {
+        if (np_.verbose_progress) {
+          std::cout << ++index << ": collapse queue size = "
+            << collapse_candidate_queue.size() << " ";
+        }
+        unsigned int nb_collapsed = collapse_applied_in_batch(
+          max_error_threshold_value, &large_error_queue,
+          &collapse_candidate_queue);
+        nb_operations += nb_collapsed;
+        if (np_.verbose_progress) {
+          std::cout << nb_collapsed << " edges collapsed" << std::endl;
+        }
+      } else if (!collapse_candidate_queue.empty()) {
         if (np_.verbose_progress) {
           std::cout << ++index << ": collapse queue size = "
             << collapse_candidate_queue.size() << " ";
@@ -546,13 +714,17 @@ class Minangle_remesher {
       }
     }
     std::cout << "Done (" << nb_operations << " local operations applied, "
-      << timer.time() << " s)" << std::endl;
+      << nb_collapse_simulations_skipped_ << " of " << nb_collapse_simulations_
+      << " collapse simulations skipped, " << timer.time() << " s)"
+      << std::endl;
+    Scratch_pool::purge();
   }
 
   void split_local_longest_edge() {
     if (!links_initialized_) {
       generate_samples_and_links();
     }
+    ++links_generation_;
     FT max_error = 0.0, min_radian = CGAL_PI;
     halfedge_descriptor max_error_halfedge, min_radian_halfedge;
     FT max_error_threshold_value = get_max_error_threshold_value();
@@ -573,12 +745,14 @@ class Minangle_remesher {
     } else {
       std::cout << "Error: no edge splitted" << std::endl;
     }
+    Scratch_pool::purge();
   }
 
   void increase_minimal_angle() {
     if (!links_initialized_) {
       generate_samples_and_links();
     }
+    ++links_generation_;
     // step 1: try to decrease the max error if necessary
     FT max_error_threshold_value = get_max_error_threshold_value();
     std::cout << std::endl << "Increase minimal angle..." << std::endl;
@@ -591,6 +765,7 @@ class Minangle_remesher {
           << ", max error = " << max_error << ")" << std::endl;
         greedy_reduce_error(max_error_threshold_value, max_error, true, false,
           NULL, NULL, max_error_halfedge);
+        Scratch_pool::purge();
         return;
       }
     }
@@ -603,12 +778,14 @@ class Minangle_remesher {
       << " degree)" << std::endl;
     greedy_improve_angle(max_error_threshold_value, min_radian, true, NULL,
       NULL, min_radian_halfedge);
+    Scratch_pool::purge();
   }
 
   void maximize_minimal_angle() {
     if (!links_initialized_) {
       generate_samples_and_links();
     }
+    ++links_generation_;
     FT max_error_threshold_value = get_max_error_threshold_value();
     FT min_radian_threshold = remesh_->to_radian(np_.min_angle_threshold);
     CGAL::Timer timer;
@@ -621,15 +798,24 @@ class Minangle_remesher {
     FT max_error = 0, min_radian = CGAL_PI;
     halfedge_descriptor max_error_halfedge, min_radian_halfedge;
     unsigned int nb_operations = 0;
+    collapsed_table_.reset_statistics();
     // Version 1: use dynamic priority queue
     DPQueue_halfedge_long large_error_queue;
     DPQueue_halfedge_short small_radian_queue;
     remesh_->fill_small_radian_edges(max_error_threshold_value,
       &large_error_queue, &small_radian_queue, np_);
+    unsigned int nb_compactions = 0;
+    cancelled_ = false;
     while (remesh_->size_of_vertices() < np_.max_mesh_complexity &&
-      (!large_error_queue.empty() || !small_radian_queue.empty())) {
+      (!large_error_queue.empty() || !small_radian_queue.empty()) &&
+      report_progress()) {
+      if (np_.max_garbage_ratio > 0.0 &&
+        remesh_->calculate_garbage_ratio() > np_.max_garbage_ratio) {
+        remesh_->collect_garbage(&large_error_queue, &small_radian_queue);
+        ++nb_compactions;
+      }
       while (remesh_->size_of_vertices() < np_.max_mesh_complexity &&
-        !large_error_queue.empty()) {
+        !large_error_queue.empty() && report_progress()) {
         typename DPQueue_halfedge_long::right_map::iterator eit =
           large_error_queue.right.begin();
         max_error = CGAL::sqrt(eit->first);
@@ -643,6 +829,9 @@ class Minangle_remesher {
           np_.verbose_progress, false, &large_error_queue,
           &small_radian_queue, max_error_halfedge);
       }
+      if (cancelled_) {
+        break;
+      }
       if (remesh_->size_of_vertices() < np_.max_mesh_complexity &&
         !small_radian_queue.empty()) {
         typename DPQueue_halfedge_short::right_map::iterator eit =
@@ -706,13 +895,18 @@ class Minangle_remesher {
     }
     }*/
     std::cout << "Done (" << nb_operations << " local operations applied, "
-      << timer.time() << " s)" << std::endl;
+      << collapsed_table_.nb_hits() << " of " << collapsed_table_.nb_lookups()
+      << " loop checks hit (" << 100.0 * collapsed_table_.hit_rate()
+      << "%), " << nb_compactions << " compactions, " << timer.time()
+      << " s)" << std::endl;
+    Scratch_pool::purge();
   }
 
   void final_vertex_relocation() {
     if (!links_initialized_) {
       generate_samples_and_links();
     }
+    ++links_generation_;
     FT max_error_threshold_value = get_max_error_threshold_value();
     CGAL::Timer timer;
     timer.start();
@@ -723,7 +917,8 @@ class Minangle_remesher {
     DPQueue_vertex_short relocate_candidate_queue;
     remesh_->fill_relocate_candidate_vertices(&relocate_candidate_queue);
     unsigned int index = 0, nb_relocate = 0;
-    while (!relocate_candidate_queue.empty()) {
+    cancelled_ = false;
+    while (!relocate_candidate_queue.empty() && report_progress()) {
       if (np_.verbose_progress) {
         std::cout << ++index << ": relocate queue size = "
           << relocate_candidate_queue.size() << " ";
@@ -754,6 +949,7 @@ class Minangle_remesher {
     }
     std::cout << "Done (" << nb_relocate << " vertices relocated, "
       << timer.time() << " s)" << std::endl;
+    Scratch_pool::purge();
   }
 
  private:
@@ -789,14 +985,14 @@ class Minangle_remesher {
 
   // 3) sample and links
   void clear_links() {
+    ++links_generation_;
     // step 1: clear the out links
     remesh_->clear_out_links();
     // step 2: clear the in links (out links from the perspective of m_pInput)
     remesh_->clear_in_link_iterators();
     input_->clear_out_links();
     // step 3: clear private data
-    collapsed_list_.clear();
-    collapsed_map_.clear();
+    collapsed_table_.clear();
   }
 
   // 4) manipulations
@@ -910,46 +1106,21 @@ class Minangle_remesher {
   }
 
   bool caused_infinite_loop(halfedge_descriptor hd) {
-    typename std::map<Point, std::map<FT, Visit_iter>, Point_Comp>::iterator it1;
-    Visit_iter it2;
+    std::size_t capacity = std::max(np_.collapsed_list_size, 0);
+    if (collapsed_table_.capacity() != capacity) {
+      collapsed_table_.reset(capacity);
+    }
     Point point = remesh_->get_point(remesh_->get_opposite_vertex(hd));
     FT sl = remesh_->squared_length(hd);
     sl = to_approximation(sl);
-    bool found = false;
-    it1 = collapsed_map_.find(point);
-    if (it1 != collapsed_map_.end()) {
-      typename std::map<FT, Visit_iter>::iterator it = it1->second.find(sl);
-      if (it != it1->second.end()) {
-        found = true;
-        it2 = it->second;
-      }
-    }
-    if (found) {
+    if (collapsed_table_.visit(to_visit_key(point, sl))) {
       if (np_.verbose_progress) {
         std::cout << "Point(" << point << ") with length "
           << sl << ": collapse denied.";
       }
-      // option: we may delete it instead of splicing front
-      collapsed_list_.splice(collapsed_list_.begin(),
-        collapsed_list_, it2);
       return true;
-    } else {
-      collapsed_list_.push_front(std::pair<Point, FT>(point, sl));
-      collapsed_map_[point][sl] = collapsed_list_.begin();
-      while (collapsed_list_.size() > np_.collapsed_list_size) {
-        const Point &p = collapsed_list_.back().first;
-        FT sl = collapsed_list_.back().second;
-        it1 = collapsed_map_.find(p);
-        if (it1 != collapsed_map_.end()) {
-          it1->second.erase(sl);
-          if (it1->second.size() == 0) {
-            collapsed_map_.erase(it1);
-          }
-        }
-        collapsed_list_.pop_back();
-      }
-      return false;
     }
+    return false;
   }
 
   // 5) collapse
@@ -962,75 +1133,221 @@ class Minangle_remesher {
     if infinite_loop is not NULL, we check the infinite loop case;
     if improve_min_radian, we improve the min radian; otherwise,
     we collapse to reduce the mesh complexity */
+    // step 1: topology, geometry and error bound checks, links backup
+    Collapse_candidate candidate;
+    candidate.hd = hd;
+    if (!prepare_collapse_candidate(max_error_threshold_value, np,
+        &candidate)) {
+      return remesh_->get_null_vertex();
+    }
+    // step 2: simulate the edge collapse
+    simulate_collapse_candidate(&candidate);
+    // step 3: check the constraints and collapse the edge authentically
+    return commit_collapse_candidate(max_error_threshold_value, min_radian,
+      reduce_complexity, infinite_loop, large_error_queue, small_value_queue,
+      &candidate);
+  }
+
+  unsigned int collapse_applied_in_batch(FT max_error_threshold_value,
+      DPQueue_halfedge_long *large_error_queue,
+      DPQueue_halfedge_short *collapse_candidate_queue) {
+    /* speculative variant of the collapse step of the initial simplification:
+    pop up to collapse_batch_size candidates, simulate those whose stencils
+    (vertices of the extended faces) do not overlap concurrently, and commit
+    the accepted ones in priority order. Overlapping candidates are put back
+    into the queue and re-validated in a later batch. */
+    // step 1: pop the candidates and keep the non-overlapping ones
+    std::vector<Collapse_candidate> candidates;
+    std::vector<Halfedge_short> deferred;
+    Vertex_set claimed_vertices;
+    int batch_size = np_.collapse_batch_size;
+    while (!collapse_candidate_queue->empty() &&
+        static_cast<int>(candidates.size() + deferred.size()) < batch_size) {
+      typename DPQueue_halfedge_short::right_map::iterator eit =
+        collapse_candidate_queue->right.begin();
+      halfedge_descriptor hd = eit->second;
+      FT priority = eit->first;
+      collapse_candidate_queue->right.erase(eit);
+      collapse_candidate_queue->left.erase(remesh_->get_opposite(hd));
+      Collapse_candidate candidate;
+      candidate.hd = hd;
+      if (!prepare_collapse_candidate(max_error_threshold_value, np_,
+          &candidate)) {
+        continue;
+      }
+      Vertex_set stencil;
+      remesh_->collect_vertices(candidate.extended_faces, &stencil);
+      bool overlapped = false;
+      for (auto it = stencil.begin(); it != stencil.end(); ++it) {
+        if (claimed_vertices.find(*it) != claimed_vertices.end()) {
+          overlapped = true;
+          break;
+        }
+      }
+      if (overlapped) {
+        deferred.push_back(Halfedge_short(hd, priority));
+      } else {
+        claimed_vertices.insert(stencil.begin(), stencil.end());
+        candidates.push_back(std::move(candidate));
+      }
+    }
+    for (auto it = deferred.begin(); it != deferred.end(); ++it) {
+      collapse_candidate_queue->insert(*it);
+    }
+    // step 2: simulate them concurrently, the stencils share no links
+#ifdef CGAL_LINKED_WITH_TBB
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, candidates.size()),
+      [&](const tbb::blocked_range<std::size_t> &range) {
+      for (std::size_t i = range.begin(); i != range.end(); ++i) {
+        simulate_collapse_candidate(&candidates[i]);
+      }
+    });
+#else
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+      simulate_collapse_candidate(&candidates[i]);
+    }
+#endif
+    // step 3: commit the accepted ones in priority order
+    unsigned int nb_collapsed = 0;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+      vertex_descriptor vd = commit_collapse_candidate(
+        max_error_threshold_value, -1.0, true, NULL, large_error_queue,
+        collapse_candidate_queue, &candidates[i]);
+      if (vd != remesh_->get_null_vertex()) {
+        ++nb_collapsed;
+      }
+    }
+    return nb_collapsed;
+  }
+
+  bool prepare_collapse_candidate(FT max_error_threshold_value,
+      const NamedParameters &np, Collapse_candidate *candidate) {
+    halfedge_descriptor hd = candidate->hd;
     // step 1: topology constraints check
     if (!remesh_->is_collapsable(hd, np)) {
-      return remesh_->get_null_vertex();
+      return false;
     }
     // step 2: geometry constraints check
-    Halfedge_list halfedges;  // use the halfedges to represent faces
-    bool is_ring = remesh_->predict_faces_after_collapse(hd, &halfedges);
-    Point new_point = remesh_->calculate_initial_point_for_collapse(hd, np_);
+    // use the halfedges to represent faces
+    remesh_->predict_faces_after_collapse(hd, &candidate->halfedges);
+    candidate->new_point = remesh_->calculate_initial_point_for_collapse(hd,
+      np_);
     if (np_.keep_vertex_in_one_ring &&
-        remesh_->collapse_would_cause_wrinkle(halfedges, new_point, hd)) {
-      return remesh_->get_null_vertex();
+        remesh_->collapse_would_cause_wrinkle(candidate->halfedges,
+        candidate->new_point, hd)) {
+      return false;
     }
-    // step 3: backup the original local links
-    std::set<face_descriptor> one_ring_faces, extended_faces;
-    remesh_->collect_one_ring_faces_incident_to_edge(hd, &one_ring_faces);
-    remesh_->extend_faces(one_ring_faces, np_.stencil_ring_size,
-                          &extended_faces);
-    Link_iter_list face_in_links, edge_in_links;
-    Link_pointer_list vertex_in_links;
-    Point_list face_in_end_points, edge_in_end_points, vertex_in_end_points;
-    remesh_->backup_local_in_links(extended_faces, &face_in_links,
-        &face_in_end_points, &edge_in_links, &edge_in_end_points,
-        &vertex_in_links, &vertex_in_end_points);
-    // step 4: simulate the edge collapse
-    FT error = DOUBLE_MAX, radian = 0.0;
-    simulate_edge_collapse(one_ring_faces, extended_faces, halfedges, hd,
-        is_ring, face_in_links, edge_in_links, vertex_in_links, &error,
-        &radian, &new_point);
-    remesh_->restore_local_in_links(face_in_end_points, face_in_links,
-        edge_in_end_points, edge_in_links, vertex_in_end_points,
-        vertex_in_links);
-    // step 5: fidelity constraints check (max_error)
-    if (error >= max_error_threshold_value) {
+    // step 3: collect the stencil
+    remesh_->collect_one_ring_faces_incident_to_edge(hd,
+      &candidate->one_ring_faces);
+    remesh_->extend_faces(candidate->one_ring_faces, np_.stencil_ring_size,
+                          &candidate->extended_faces);
+    // step 4: reject hopeless collapses before building the local mesh
+    ++nb_collapse_simulations_;
+    FT slack = calculate_collapse_slack(candidate->halfedges,
+      candidate->new_point);
+    if (slack >= 0.0 && remesh_->collapse_would_exceed_error(
+        candidate->one_ring_faces, candidate->extended_faces,
+        candidate->halfedges, candidate->new_point, slack,
+        max_error_threshold_value)) {
+      ++nb_collapse_simulations_skipped_;
+      return false;
+    }
+    // step 5: backup the original local links
+    remesh_->backup_local_in_links(candidate->extended_faces,
+        &candidate->face_in_links, &candidate->face_in_end_points,
+        &candidate->edge_in_links, &candidate->edge_in_end_points,
+        &candidate->vertex_in_links, &candidate->vertex_in_end_points);
+    return true;
+  }
+
+  void simulate_collapse_candidate(Collapse_candidate *candidate) const {
+    // only touches the in links of the candidate, restored afterwards
+    candidate->error = DOUBLE_MAX;
+    candidate->radian = 0.0;
+    simulate_edge_collapse(candidate->one_ring_faces,
+        candidate->extended_faces, candidate->halfedges, candidate->hd,
+        candidate->face_in_links, candidate->edge_in_links,
+        candidate->vertex_in_links,
+        &candidate->error, &candidate->radian, &candidate->new_point);
+    remesh_->restore_local_in_links(candidate->face_in_end_points,
+        candidate->face_in_links, candidate->edge_in_end_points,
+        candidate->edge_in_links, candidate->vertex_in_end_points,
+        candidate->vertex_in_links);
+  }
+
+  vertex_descriptor commit_collapse_candidate(FT max_error_threshold_value,
+      FT min_radian, bool reduce_complexity, bool *infinite_loop,
+      DPQueue_halfedge_long *large_error_queue,
+      DPQueue_halfedge_short *small_value_queue,
+      Collapse_candidate *candidate) {
+    halfedge_descriptor hd = candidate->hd;
+    // step 1: fidelity constraints check (max_error)
+    if (candidate->error >= max_error_threshold_value) {
       return remesh_->get_null_vertex();
     }
-    // step 6: quality constraints check (min_radian) if necessary
-    if (min_radian > 0 && radian < min_radian) {
+    // step 2: quality constraints check (min_radian) if necessary
+    if (min_radian > 0 && candidate->radian < min_radian) {
       return remesh_->get_null_vertex();
     }
-    // step 7: infinite loops case check if necessary
+    // step 3: infinite loops case check if necessary
     if (infinite_loop != NULL) {
       *infinite_loop = caused_infinite_loop(hd);
       if (*infinite_loop) {
         return remesh_->get_null_vertex();
       }
     }
-    // step 8: collapse the edge authentically
+    // step 4: collapse the edge authentically
     vertex_descriptor vh = remesh_->collapse_edge(input_face_tree_,
       max_error_threshold_value, min_radian, reduce_complexity,
-      large_error_queue, small_value_queue, face_in_links, edge_in_links,
-      vertex_in_links, hd, new_point, np_);
+      large_error_queue, small_value_queue, candidate->face_in_links,
+      candidate->edge_in_links, candidate->vertex_in_links, hd,
+      candidate->new_point, np_);
     return vh;
   }
 
-  void simulate_edge_collapse(const std::set<face_descriptor> &one_ring_faces,
-      const std::set<face_descriptor> &extended_faces,
-      const Halfedge_list &halfedges, halfedge_descriptor hh, bool is_ring,
+  FT calculate_collapse_slack(const Halfedge_list &halfedges,
+      const Point &new_point) const {
+    /* how far the merged vertex may move in simulate_edge_collapse, or -1
+    if it is not bounded. Without optimization it stays at new_point; when
+    kept in the one ring, each iteration moves it by at most the current
+    ring radius, which itself grows by the previous moves. */
+    if (!np_.optimize_after_local_operations) {
+      return 0.0;
+    }
+    if (!np_.keep_vertex_in_one_ring ||
+        np_.optimize_strategy == OptimizeStrategy::k_Interpolation) {
+      return -1.0;
+    }
+    FT radius = remesh_->calculate_collapse_ring_radius(halfedges, new_point);
+    int count = CGAL::max(np_.vertex_optimize_count, 0);
+    return radius * (std::ldexp(1.0, count) - 1.0);   // 2^count - 1
+  }
+
+  void simulate_edge_collapse(const Face_set &one_ring_faces,
+      const Face_set &extended_faces,
+      const Halfedge_list &halfedges, halfedge_descriptor hh,
       const Link_iter_list &face_in_links, const Link_iter_list &edge_in_links,
       const Link_pointer_list &vertex_in_links, FT *error, FT *radian,
       Point *new_point) const {
     // step 1: construct the local_mesh
     Mesh local_mesh;
+    std::vector<vertex_descriptor> source_vertices;
     vertex_descriptor local_vd = remesh_->construct_local_mesh(one_ring_faces,
-        extended_faces, halfedges, *new_point, is_ring, &local_mesh);
+        extended_faces, halfedges, *new_point, &local_mesh, &source_vertices);
+    if (local_vd == remesh_->get_null_vertex()) {
+      *error = DOUBLE_MAX;    // not a 2-manifold patch, reject the collapse
+      *radian = 0.0;
+      return;
+    }
     Mesh_properties_ local_mp(&local_mesh);
-    NamedParameters np(np_);
-    local_mp.calculate_feature_intensities(&np);
+    local_mp.set_link_origin(remesh_->get_link_origin());
+    // only the faces around local_vd changed, the rest comes from remesh_
+    local_mp.calculate_local_feature_intensities(*remesh_, source_vertices,
+        local_vd, np_);
+    local_mp.inherit_max_squared_errors(*remesh_, one_ring_faces, local_vd);
     // step 2: get the in_link_faces (for function compatability)
-    std::set<face_descriptor> in_link_faces;
+    Face_set in_link_faces;
     local_mp.collect_all_faces(&in_link_faces);
     local_mp.generate_local_links(input_face_tree_, true, face_in_links,
         edge_in_links, vertex_in_links, local_vd, in_link_faces, np_);
@@ -1048,19 +1365,46 @@ class Minangle_remesher {
   }
 
   // 6) utilities
+  void update_max_squared_error_threshold() {
+    // used by SampleStrategy::k_error_driven on the remesh faces only, the
+    // max errors are not computed for the input faces
+    if (input_ != NULL && remesh_ != NULL) {
+      FT threshold = get_max_error_threshold_value();
+      remesh_->set_max_squared_error_threshold(threshold * threshold);
+    }
+  }
+
+  bool report_progress() {
+    // returns false (once and for all) if the operation has been cancelled
+    if (!cancelled_ && progress_callback_ && !progress_callback_()) {
+      cancelled_ = true;
+      std::cout << "Cancelled" << std::endl;
+    }
+    return !cancelled_;
+  }
+
   inline FT to_approximation(FT value) const {
     FT precison = MAX_VALUE;
     int temp_value = value * precison;
     return temp_value / precison;
   }
 
+  inline Visit_key to_visit_key(const Point &point, FT sl) const {
+    // points are snapped to a MIN_VALUE grid, lengths as to_approximation()
+    Visit_key key;
+    key.values[0] = std::llround(point.x() / MIN_VALUE);
+    key.values[1] = std::llround(point.y() / MIN_VALUE);
+    key.values[2] = std::llround(point.z() / MIN_VALUE);
+    key.values[3] = std::llround(sl * MAX_VALUE);
+    return key;
+  }
+
  private:
   // 1) parameters
   NamedParameters np_;
 
   // 2) the collapse operator
-  Visit_list collapsed_list_;
-  std::map<Point, std::map<FT, Visit_iter>, Point_Comp> collapsed_map_;
+  Visit_table collapsed_table_;
 
   // 3) member data and properties
   Mesh_properties_ *input_, *remesh_;
@@ -1069,7 +1413,12 @@ class Minangle_remesher {
 
   // 4) status data
   bool links_initialized_;
+  unsigned int links_generation_;
   bool input_aabb_tree_constructed_;
+  bool cancelled_;
+  Progress_callback progress_callback_;
+  unsigned int nb_collapse_simulations_;
+  unsigned int nb_collapse_simulations_skipped_;
 
   // 5) const data
   int const INITIAL_BVD_COUNT = 5;
@@ -0,0 +1,184 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+#ifndef SRC_INTERNAL_MINANGLE_REMESHING_SCRATCH_ALLOCATOR_H_
+#define SRC_INTERNAL_MINANGLE_REMESHING_SCRATCH_ALLOCATOR_H_
+
+// C/C++
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace CGAL {
+namespace Polygon_mesh_processing {
+namespace internal {
+
+// Node recycling for the short-lived node based containers of the local
+// operations (Face_set, Halfedge_list, ...). Freed nodes are kept in free
+// lists per size class and per thread, so the next operation reuses them
+// without calling malloc or taking a lock. Each thread keeps at most
+// k_max_free_bytes of free nodes, and purge() returns the free nodes of the
+// calling thread (the remesher calls it at the end of each operation).
+class Scratch_pool {
+ public:
+  static void* allocate(std::size_t size) {
+    std::size_t c = size_class(size);
+    if (c >= k_nb_classes) {
+      return ::operator new(size);
+    }
+    Free_lists &lists = free_lists();
+    Node *node = lists.heads[c];
+    if (node != NULL) {
+      lists.heads[c] = node->next;
+      lists.free_bytes -= class_size(c);
+      return node;
+    }
+    held_bytes() += class_size(c);
+    ++held_nodes();
+    return ::operator new(class_size(c));
+  }
+
+  static void deallocate(void *p, std::size_t size) {
+    std::size_t c = size_class(size);
+    if (c >= k_nb_classes) {
+      ::operator delete(p);
+      return;
+    }
+    Free_lists &lists = free_lists();
+    if (lists.free_bytes + class_size(c) > k_max_free_bytes) {
+      held_bytes() -= class_size(c);
+      --held_nodes();
+      ::operator delete(p);
+      return;
+    }
+    Node *node = static_cast<Node*>(p);
+    node->next = lists.heads[c];
+    lists.heads[c] = node;
+    lists.free_bytes += class_size(c);
+  }
+
+  static void purge() { free_lists().purge(); }
+
+  // bytes of the nodes obtained from the system and not returned yet, in use
+  // or free, over all the threads
+  static std::size_t held() { return held_bytes(); }
+  static std::size_t held_count() { return held_nodes(); }
+
+ private:
+  static const std::size_t k_granularity = 16;       // keeps new's alignment
+  static const std::size_t k_nb_classes = 8;         // nodes up to 128 bytes
+  static const std::size_t k_max_free_bytes = 1 << 20;
+
+  struct Node {
+    Node *next;
+  };
+
+  struct Free_lists {
+    Free_lists() : free_bytes(0) {
+      for (std::size_t c = 0; c < k_nb_classes; ++c) {
+        heads[c] = NULL;
+      }
+    }
+    ~Free_lists() { purge(); }
+
+    void purge() {
+      for (std::size_t c = 0; c < k_nb_classes; ++c) {
+        while (heads[c] != NULL) {
+          Node *node = heads[c];
+          heads[c] = node->next;
+          held_bytes() -= class_size(c);
+          --held_nodes();
+          ::operator delete(node);
+        }
+      }
+      free_bytes = 0;
+    }
+
+    Node *heads[k_nb_classes];
+    std::size_t free_bytes;
+  };
+
+  static std::size_t size_class(std::size_t size) {
+    return (size + k_granularity - 1) / k_granularity - 1;
+  }
+
+  static std::size_t class_size(std::size_t c) {
+    return (c + 1) * k_granularity;
+  }
+
+  static Free_lists& free_lists() {
+    static thread_local Free_lists lists;
+    return lists;
+  }
+
+  static std::atomic<std::size_t>& held_bytes() {
+    static std::atomic<std::size_t> bytes(0);
+    return bytes;
+  }
+
+  static std::atomic<std::size_t>& held_nodes() {
+    static std::atomic<std::size_t> nodes(0);
+    return nodes;
+  }
+};
+
+// Stateless allocator on Scratch_pool. Single nodes are recycled, arrays go
+// to operator new.
+template <class T>
+class Scratch_allocator {
+ public:
+  typedef T value_type;
+
+  Scratch_allocator() {}
+  template <class U>
+  Scratch_allocator(const Scratch_allocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    if (n == 1) {
+      return static_cast<T*>(Scratch_pool::allocate(sizeof(T)));
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    if (n == 1) {
+      Scratch_pool::deallocate(p, sizeof(T));
+    } else {
+      ::operator delete(p);
+    }
+  }
+};
+
+template <class T, class U>
+bool operator == (const Scratch_allocator<T>&, const Scratch_allocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+bool operator != (const Scratch_allocator<T>&, const Scratch_allocator<U>&) {
+  return false;
+}
+
+}   // namespace internal
+}   // namespace Polygon_mesh_processing
+}   // namespace CGAL
+
+#endif  // SRC_INTERNAL_MINANGLE_REMESHING_SCRATCH_ALLOCATOR_H_
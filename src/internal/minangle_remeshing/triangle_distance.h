@@ -0,0 +1,438 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+#ifndef SRC_INTERNAL_MINANGLE_REMESHING_TRIANGLE_DISTANCE_H_
+#define SRC_INTERNAL_MINANGLE_REMESHING_TRIANGLE_DISTANCE_H_
+
+// C/C++
+#include <cstddef>
+#include <vector>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace CGAL {
+namespace Polygon_mesh_processing {
+namespace internal {
+
+// Closest point queries of one point against a batch of triangles, on raw
+// double coordinates. For each triangle the candidates are the projection
+// onto its plane (valid only if it falls inside) and the nearest points on
+// its three edges; the nearest candidate wins. There is no branching per
+// triangle, so four triangles are processed per AVX2 instruction, and the
+// scalar path is used if the cpu does not support AVX2.
+class Triangle_batch {
+ public:
+  Triangle_batch() : size_(0) {}
+
+  void clear() {
+    size_ = 0;
+    for (int i = 0; i < k_nb_arrays; ++i) {
+      data_[i].clear();
+    }
+  }
+
+  void reserve(std::size_t n) {
+    for (int i = 0; i < k_nb_arrays; ++i) {
+      data_[i].reserve(padded(n));
+    }
+  }
+
+  std::size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  void add(double ax, double ay, double az, double bx, double by, double bz,
+      double cx, double cy, double cz) {
+    double abx = bx - ax, aby = by - ay, abz = bz - az;
+    double acx = cx - ax, acy = cy - ay, acz = cz - az;
+    double bcx = cx - bx, bcy = cy - by, bcz = cz - bz;
+    double nx = aby * acz - abz * acy;
+    double ny = abz * acx - abx * acz;
+    double nz = abx * acy - aby * acx;
+    double nn = nx * nx + ny * ny + nz * nz;
+    double ab2 = abx * abx + aby * aby + abz * abz;
+    double ac2 = acx * acx + acy * acy + acz * acz;
+    double bc2 = bcx * bcx + bcy * bcy + bcz * bcz;
+    double values[k_nb_arrays] = {ax, ay, az, abx, aby, abz, acx, acy, acz,
+      nx, ny, nz, inverse(nn), inverse(ab2), inverse(ac2), inverse(bc2)};
+    if (size_ % k_lanes == 0) {
+      // pad to a multiple of the lane count with copies of this triangle,
+      // so that the vectorized loop never needs a remainder
+      for (int i = 0; i < k_nb_arrays; ++i) {
+        data_[i].resize(size_ + k_lanes, values[i]);
+      }
+    } else {
+      for (int i = 0; i < k_nb_arrays; ++i) {
+        data_[i][size_] = values[i];
+      }
+    }
+    ++size_;
+  }
+
+  // returns the index of the nearest triangle (-1 if the batch is empty),
+  // with the nearest point in (qx, qy, qz) and its squared distance in sd
+  int closest(double px, double py, double pz,
+      double *qx, double *qy, double *qz, double *sd) const {
+    if (size_ == 0) {
+      return -1;
+    }
+#ifdef CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+    if (has_avx2()) {
+      return closest_avx2(px, py, pz, qx, qy, qz, sd);
+    }
+#endif
+    return closest_scalar(px, py, pz, qx, qy, qz, sd);
+  }
+
+  int closest_scalar(double px, double py, double pz,
+      double *qx, double *qy, double *qz, double *sd) const {
+    int index = -1;
+    double min_sd = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < size_; ++i) {
+      double x, y, z;
+      double d = closest_point(i, px, py, pz, &x, &y, &z);
+      if (d < min_sd) {
+        min_sd = d;
+        index = static_cast<int>(i);
+        *qx = x;
+        *qy = y;
+        *qz = z;
+      }
+    }
+    *sd = min_sd;
+    return index;
+  }
+
+  static bool has_avx2() {
+#ifdef CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+#else
+    return false;
+#endif
+  }
+
+ private:
+  enum Arrays {
+    k_ax = 0, k_ay, k_az,         // the first vertex
+    k_abx, k_aby, k_abz,          // edge vectors
+    k_acx, k_acy, k_acz,
+    k_nx, k_ny, k_nz,             // unnormalized normal
+    k_inv_nn,                     // 1 / |n|^2
+    k_inv_ab, k_inv_ac, k_inv_bc, // 1 / |e|^2
+    k_nb_arrays
+  };
+  static const int k_lanes = 4;
+
+  static std::size_t padded(std::size_t n) {
+    return (n + k_lanes - 1) / k_lanes * k_lanes;
+  }
+
+  // degenerated triangles or edges get 0, which disables the projection
+  // and snaps the edge parameter to its source
+  static double inverse(double value) {
+    return value > 1e-300 ? 1.0 / value : 0.0;
+  }
+
+  static double clamp01(double t) {
+    return t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+  }
+
+  double closest_point(std::size_t i, double px, double py, double pz,
+      double *qx, double *qy, double *qz) const {
+    const double ax = data_[k_ax][i], ay = data_[k_ay][i], az = data_[k_az][i];
+    const double abx = data_[k_abx][i], aby = data_[k_aby][i],
+      abz = data_[k_abz][i];
+    const double acx = data_[k_acx][i], acy = data_[k_acy][i],
+      acz = data_[k_acz][i];
+    const double nx = data_[k_nx][i], ny = data_[k_ny][i], nz = data_[k_nz][i];
+    const double dx = px - ax, dy = py - ay, dz = pz - az;
+    // candidate 1: edge ab
+    double t = clamp01((dx * abx + dy * aby + dz * abz) * data_[k_inv_ab][i]);
+    double x = ax + t * abx, y = ay + t * aby, z = az + t * abz;
+    double min_sd = squared_length(px - x, py - y, pz - z);
+    *qx = x; *qy = y; *qz = z;
+    // candidate 2: edge ac
+    t = clamp01((dx * acx + dy * acy + dz * acz) * data_[k_inv_ac][i]);
+    x = ax + t * acx; y = ay + t * acy; z = az + t * acz;
+    double sd = squared_length(px - x, py - y, pz - z);
+    if (sd < min_sd) {
+      min_sd = sd; *qx = x; *qy = y; *qz = z;
+    }
+    // candidate 3: edge bc
+    const double bx = ax + abx, by = ay + aby, bz = az + abz;
+    const double bcx = acx - abx, bcy = acy - aby, bcz = acz - abz;
+    t = clamp01(((px - bx) * bcx + (py - by) * bcy + (pz - bz) * bcz) *
+      data_[k_inv_bc][i]);
+    x = bx + t * bcx; y = by + t * bcy; z = bz + t * bcz;
+    sd = squared_length(px - x, py - y, pz - z);
+    if (sd < min_sd) {
+      min_sd = sd; *qx = x; *qy = y; *qz = z;
+    }
+    // candidate 4: the projection, if inside (barycentric signs w.r.t. n)
+    const double wc = nx * (aby * dz - abz * dy) + ny * (abz * dx - abx * dz) +
+      nz * (abx * dy - aby * dx);
+    const double wb = nx * (dy * acz - dz * acy) + ny * (dz * acx - dx * acz) +
+      nz * (dx * acy - dy * acx);
+    const double nn = nx * nx + ny * ny + nz * nz;
+    const double inv_nn = data_[k_inv_nn][i];
+    if (inv_nn > 0.0 && wb >= 0.0 && wc >= 0.0 && wb + wc <= nn) {
+      const double h = (dx * nx + dy * ny + dz * nz) * inv_nn;
+      sd = h * h * nn;
+      if (sd < min_sd) {
+        min_sd = sd; *qx = px - h * nx; *qy = py - h * ny; *qz = pz - h * nz;
+      }
+    }
+    return min_sd;
+  }
+
+  static double squared_length(double x, double y, double z) {
+    return x * x + y * y + z * z;
+  }
+
+#ifdef CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+  __attribute__((target("avx2")))
+  static inline __m256d clamp01_avx2(__m256d t) {
+    return _mm256_min_pd(_mm256_max_pd(t, _mm256_setzero_pd()),
+      _mm256_set1_pd(1.0));
+  }
+
+  __attribute__((target("avx2")))
+  static inline __m256d dot_avx2(__m256d ax, __m256d ay, __m256d az,
+      __m256d bx, __m256d by, __m256d bz) {
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ax, bx),
+      _mm256_mul_pd(ay, by)), _mm256_mul_pd(az, bz));
+  }
+
+  // keeps the candidate (x, y, z, sd) in the lanes where it is nearer
+  __attribute__((target("avx2")))
+  static inline void select_avx2(__m256d mask, __m256d x, __m256d y,
+      __m256d z, __m256d sd, __m256d *qx, __m256d *qy, __m256d *qz,
+      __m256d *min_sd) {
+    *qx = _mm256_blendv_pd(*qx, x, mask);
+    *qy = _mm256_blendv_pd(*qy, y, mask);
+    *qz = _mm256_blendv_pd(*qz, z, mask);
+    *min_sd = _mm256_blendv_pd(*min_sd, sd, mask);
+  }
+
+  __attribute__((target("avx2")))
+  int closest_avx2(double px, double py, double pz,
+      double *qx, double *qy, double *qz, double *sd) const {
+    const __m256d vpx = _mm256_set1_pd(px);
+    const __m256d vpy = _mm256_set1_pd(py);
+    const __m256d vpz = _mm256_set1_pd(pz);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d best_sd = _mm256_set1_pd(std::numeric_limits<double>::max());
+    __m256d best_x = zero, best_y = zero, best_z = zero;
+    __m256d best_index = _mm256_set1_pd(-1.0);
+    __m256d index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const __m256d step = _mm256_set1_pd(static_cast<double>(k_lanes));
+    for (std::size_t i = 0; i < data_[0].size(); i += k_lanes) {
+      const __m256d ax = _mm256_loadu_pd(&data_[k_ax][i]);
+      const __m256d ay = _mm256_loadu_pd(&data_[k_ay][i]);
+      const __m256d az = _mm256_loadu_pd(&data_[k_az][i]);
+      const __m256d abx = _mm256_loadu_pd(&data_[k_abx][i]);
+      const __m256d aby = _mm256_loadu_pd(&data_[k_aby][i]);
+      const __m256d abz = _mm256_loadu_pd(&data_[k_abz][i]);
+      const __m256d acx = _mm256_loadu_pd(&data_[k_acx][i]);
+      const __m256d acy = _mm256_loadu_pd(&data_[k_acy][i]);
+      const __m256d acz = _mm256_loadu_pd(&data_[k_acz][i]);
+      const __m256d dx = _mm256_sub_pd(vpx, ax);
+      const __m256d dy = _mm256_sub_pd(vpy, ay);
+      const __m256d dz = _mm256_sub_pd(vpz, az);
+      // candidate 1: edge ab
+      __m256d t = clamp01_avx2(_mm256_mul_pd(dot_avx2(dx, dy, dz,
+        abx, aby, abz), _mm256_loadu_pd(&data_[k_inv_ab][i])));
+      __m256d x = _mm256_add_pd(ax, _mm256_mul_pd(t, abx));
+      __m256d y = _mm256_add_pd(ay, _mm256_mul_pd(t, aby));
+      __m256d z = _mm256_add_pd(az, _mm256_mul_pd(t, abz));
+      __m256d ex = _mm256_sub_pd(vpx, x);
+      __m256d ey = _mm256_sub_pd(vpy, y);
+      __m256d ez = _mm256_sub_pd(vpz, z);
+      __m256d min_sd = dot_avx2(ex, ey, ez, ex, ey, ez);
+      __m256d cx = x, cy = y, cz = z;
+      // candidate 2: edge ac
+      t = clamp01_avx2(_mm256_mul_pd(dot_avx2(dx, dy, dz, acx, acy, acz),
+        _mm256_loadu_pd(&data_[k_inv_ac][i])));
+      x = _mm256_add_pd(ax, _mm256_mul_pd(t, acx));
+      y = _mm256_add_pd(ay, _mm256_mul_pd(t, acy));
+      z = _mm256_add_pd(az, _mm256_mul_pd(t, acz));
+      ex = _mm256_sub_pd(vpx, x);
+      ey = _mm256_sub_pd(vpy, y);
+      ez = _mm256_sub_pd(vpz, z);
+      __m256d sd2 = dot_avx2(ex, ey, ez, ex, ey, ez);
+      select_avx2(_mm256_cmp_pd(sd2, min_sd, _CMP_LT_OQ), x, y, z, sd2,
+        &cx, &cy, &cz, &min_sd);
+      // candidate 3: edge bc
+      const __m256d bx = _mm256_add_pd(ax, abx);
+      const __m256d by = _mm256_add_pd(ay, aby);
+      const __m256d bz = _mm256_add_pd(az, abz);
+      const __m256d bcx = _mm256_sub_pd(acx, abx);
+      const __m256d bcy = _mm256_sub_pd(acy, aby);
+      const __m256d bcz = _mm256_sub_pd(acz, abz);
+      t = clamp01_avx2(_mm256_mul_pd(dot_avx2(_mm256_sub_pd(vpx, bx),
+        _mm256_sub_pd(vpy, by), _mm256_sub_pd(vpz, bz), bcx, bcy, bcz),
+        _mm256_loadu_pd(&data_[k_inv_bc][i])));
+      x = _mm256_add_pd(bx, _mm256_mul_pd(t, bcx));
+      y = _mm256_add_pd(by, _mm256_mul_pd(t, bcy));
+      z = _mm256_add_pd(bz, _mm256_mul_pd(t, bcz));
+      ex = _mm256_sub_pd(vpx, x);
+      ey = _mm256_sub_pd(vpy, y);
+      ez = _mm256_sub_pd(vpz, z);
+      sd2 = dot_avx2(ex, ey, ez, ex, ey, ez);
+      select_avx2(_mm256_cmp_pd(sd2, min_sd, _CMP_LT_OQ), x, y, z, sd2,
+        &cx, &cy, &cz, &min_sd);
+      // candidate 4: the projection, if inside
+      const __m256d nx = _mm256_loadu_pd(&data_[k_nx][i]);
+      const __m256d ny = _mm256_loadu_pd(&data_[k_ny][i]);
+      const __m256d nz = _mm256_loadu_pd(&data_[k_nz][i]);
+      const __m256d inv_nn = _mm256_loadu_pd(&data_[k_inv_nn][i]);
+      const __m256d nn = dot_avx2(nx, ny, nz, nx, ny, nz);
+      const __m256d wc = dot_avx2(nx, ny, nz,
+        _mm256_sub_pd(_mm256_mul_pd(aby, dz), _mm256_mul_pd(abz, dy)),
+        _mm256_sub_pd(_mm256_mul_pd(abz, dx), _mm256_mul_pd(abx, dz)),
+        _mm256_sub_pd(_mm256_mul_pd(abx, dy), _mm256_mul_pd(aby, dx)));
+      const __m256d wb = dot_avx2(nx, ny, nz,
+        _mm256_sub_pd(_mm256_mul_pd(dy, acz), _mm256_mul_pd(dz, acy)),
+        _mm256_sub_pd(_mm256_mul_pd(dz, acx), _mm256_mul_pd(dx, acz)),
+        _mm256_sub_pd(_mm256_mul_pd(dx, acy), _mm256_mul_pd(dy, acx)));
+      const __m256d h = _mm256_mul_pd(dot_avx2(dx, dy, dz, nx, ny, nz),
+        inv_nn);
+      sd2 = _mm256_mul_pd(_mm256_mul_pd(h, h), nn);
+      __m256d inside = _mm256_and_pd(_mm256_cmp_pd(inv_nn, zero, _CMP_GT_OQ),
+        _mm256_and_pd(_mm256_cmp_pd(wb, zero, _CMP_GE_OQ),
+        _mm256_cmp_pd(wc, zero, _CMP_GE_OQ)));
+      inside = _mm256_and_pd(inside, _mm256_cmp_pd(_mm256_add_pd(wb, wc), nn,
+        _CMP_LE_OQ));
+      select_avx2(_mm256_and_pd(inside, _mm256_cmp_pd(sd2, min_sd,
+        _CMP_LT_OQ)), _mm256_sub_pd(vpx, _mm256_mul_pd(h, nx)),
+        _mm256_sub_pd(vpy, _mm256_mul_pd(h, ny)),
+        _mm256_sub_pd(vpz, _mm256_mul_pd(h, nz)), sd2,
+        &cx, &cy, &cz, &min_sd);
+      // keep the nearest triangle per lane
+      const __m256d nearer = _mm256_cmp_pd(min_sd, best_sd, _CMP_LT_OQ);
+      select_avx2(nearer, cx, cy, cz, min_sd, &best_x, &best_y, &best_z,
+        &best_sd);
+      best_index = _mm256_blendv_pd(best_index, index, nearer);
+      index = _mm256_add_pd(index, step);
+    }
+    // reduce the lanes, ties go to the smallest index as in the scalar path
+    double lane_sd[k_lanes], lane_x[k_lanes], lane_y[k_lanes], lane_z[k_lanes];
+    double lane_index[k_lanes];
+    _mm256_storeu_pd(lane_sd, best_sd);
+    _mm256_storeu_pd(lane_x, best_x);
+    _mm256_storeu_pd(lane_y, best_y);
+    _mm256_storeu_pd(lane_z, best_z);
+    _mm256_storeu_pd(lane_index, best_index);
+    int best = 0;
+    for (int j = 1; j < k_lanes; ++j) {
+      if (lane_sd[j] < lane_sd[best] || (lane_sd[j] == lane_sd[best] &&
+          lane_index[j] < lane_index[best])) {
+        best = j;
+      }
+    }
+    *qx = lane_x[best];
+    *qy = lane_y[best];
+    *qz = lane_z[best];
+    *sd = lane_sd[best];
+    return static_cast<int>(lane_index[best]);
+  }
+#endif
+
+ private:
+  std::vector<double> data_[k_nb_arrays];
+  std::size_t size_;
+};
+
+// Difference vectors of link end points, gathered into contiguous arrays so
+// that the maximal squared length (the squared error) is reduced in bulk
+// instead of link by link through the std::list iterators.
+class Squared_length_buffer {
+ public:
+  void clear() {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+  }
+
+  std::size_t size() const { return x_.size(); }
+
+  void add(double dx, double dy, double dz) {
+    x_.push_back(dx);
+    y_.push_back(dy);
+    z_.push_back(dz);
+  }
+
+  // returns 0 if the buffer is empty
+  double max() const {
+#ifdef CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+    if (x_.size() >= 8 && Triangle_batch::has_avx2()) {
+      return max_avx2();
+    }
+#endif
+    return max_scalar(0);
+  }
+
+  double max_scalar(std::size_t begin) const {
+    double max_sl = 0.0;
+    for (std::size_t i = begin; i < x_.size(); ++i) {
+      double sl = x_[i] * x_[i] + y_[i] * y_[i] + z_[i] * z_[i];
+      max_sl = sl > max_sl ? sl : max_sl;
+    }
+    return max_sl;
+  }
+
+ private:
+#ifdef CGAL_MINANGLE_TRIANGLE_DISTANCE_AVX2
+  __attribute__((target("avx2")))
+  double max_avx2() const {
+    __m256d max_sl = _mm256_setzero_pd();
+    std::size_t i = 0, n = x_.size() / 4 * 4;
+    for (; i < n; i += 4) {
+      __m256d x = _mm256_loadu_pd(&x_[i]);
+      __m256d y = _mm256_loadu_pd(&y_[i]);
+      __m256d z = _mm256_loadu_pd(&z_[i]);
+      __m256d sl = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, x),
+        _mm256_mul_pd(y, y)), _mm256_mul_pd(z, z));
+      max_sl = _mm256_max_pd(max_sl, sl);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, max_sl);
+    double value = max_scalar(i);
+    for (int j = 0; j < 4; ++j) {
+      value = lanes[j] > value ? lanes[j] : value;
+    }
+    return value;
+  }
+#endif
+
+  std::vector<double> x_, y_, z_;
+};
+
+}   // namespace internal
+}   // namespace Polygon_mesh_processing
+}   // namespace CGAL
+
+#endif  // SRC_INTERNAL_MINANGLE_REMESHING_TRIANGLE_DISTANCE_H_
@@ -0,0 +1,179 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+#ifndef SRC_INTERNAL_MINANGLE_REMESHING_VISIT_TABLE_H_
+#define SRC_INTERNAL_MINANGLE_REMESHING_VISIT_TABLE_H_
+
+// C/C++
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CGAL {
+namespace Polygon_mesh_processing {
+namespace internal {
+
+// Fixed-capacity LRU set of quantized keys (4 integers, e.g. the cell of a
+// point and a quantized length). All storage is allocated by reset(): the
+// entries form an intrusive doubly linked recency list and are chained into
+// hash buckets by index, so a visit is O(1) and never allocates.
+class Lru_visit_table {
+ public:
+  struct Key {
+    std::int64_t values[4];
+    bool operator == (const Key &other) const {
+      return values[0] == other.values[0] && values[1] == other.values[1] &&
+        values[2] == other.values[2] && values[3] == other.values[3];
+    }
+  };
+
+  explicit Lru_visit_table(std::size_t capacity = 0) { reset(capacity); }
+
+  void reset(std::size_t capacity) {
+    capacity_ = capacity;
+    entries_.assign(capacity, Entry());
+    std::size_t nb_buckets = 1;
+    while (nb_buckets < 2 * capacity) {
+      nb_buckets <<= 1;
+    }
+    buckets_.assign(nb_buckets, k_null);
+    clear();
+  }
+
+  void clear() {
+    size_ = 0;
+    head_ = tail_ = k_null;
+    buckets_.assign(buckets_.size(), k_null);
+    reset_statistics();
+  }
+
+  void reset_statistics() { nb_lookups_ = nb_hits_ = 0; }
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return capacity_; }
+  std::size_t memory_usage() const {    // in bytes, allocated by reset()
+    return entries_.capacity() * sizeof(Entry) +
+      buckets_.capacity() * sizeof(int);
+  }
+  unsigned long nb_lookups() const { return nb_lookups_; }
+  unsigned long nb_hits() const { return nb_hits_; }
+  double hit_rate() const {
+    return nb_lookups_ == 0 ? 0.0 : double(nb_hits_) / nb_lookups_;
+  }
+
+  // returns true if key is in the table (and makes it the most recent one);
+  // otherwise inserts it, evicting the least recent key if the table is full
+  bool visit(const Key &key) {
+    ++nb_lookups_;
+    if (capacity_ == 0) {
+      return false;
+    }
+    std::size_t bucket = hash(key) & (buckets_.size() - 1);
+    for (int i = buckets_[bucket]; i != k_null; i = entries_[i].chain) {
+      if (entries_[i].key == key) {
+        ++nb_hits_;
+        unlink(i);
+        push_front(i);
+        return true;
+      }
+    }
+    int i;
+    if (size_ < capacity_) {
+      i = static_cast<int>(size_++);
+    } else {      // reuse the least recent entry
+      i = tail_;
+      unlink(i);
+      unchain(i);
+    }
+    entries_[i].key = key;
+    entries_[i].bucket = bucket;
+    entries_[i].chain = buckets_[bucket];
+    buckets_[bucket] = i;
+    push_front(i);
+    return false;
+  }
+
+ private:
+  struct Entry {
+    Entry() : bucket(0), chain(k_null), prev(k_null), next(k_null) {}
+    Key key;
+    std::size_t bucket;
+    int chain;          // next entry in the same bucket
+    int prev, next;     // recency list, head_ is the most recent
+  };
+
+  static std::size_t hash(const Key &key) {
+    std::uint64_t h = 1469598103934665603ULL;
+    for (int i = 0; i < 4; ++i) {
+      h ^= static_cast<std::uint64_t>(key.values[i]);
+      h *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(h ^ (h >> 32));
+  }
+
+  void unlink(int i) {
+    Entry &e = entries_[i];
+    if (e.prev != k_null) {
+      entries_[e.prev].next = e.next;
+    } else {
+      head_ = e.next;
+    }
+    if (e.next != k_null) {
+      entries_[e.next].prev = e.prev;
+    } else {
+      tail_ = e.prev;
+    }
+    e.prev = e.next = k_null;
+  }
+
+  void push_front(int i) {
+    entries_[i].prev = k_null;
+    entries_[i].next = head_;
+    if (head_ != k_null) {
+      entries_[head_].prev = i;
+    }
+    head_ = i;
+    if (tail_ == k_null) {
+      tail_ = i;
+    }
+  }
+
+  void unchain(int i) {
+    int *link = &buckets_[entries_[i].bucket];
+    while (*link != i) {
+      link = &entries_[*link].chain;
+    }
+    *link = entries_[i].chain;
+  }
+
+  enum { k_null = -1 };
+  std::size_t capacity_, size_;
+  std::vector<Entry> entries_;
+  std::vector<int> buckets_;
+  int head_, tail_;
+  unsigned long nb_lookups_, nb_hits_;
+};
+
+}   // namespace internal
+}   // namespace Polygon_mesh_processing
+}   // namespace CGAL
+
+#endif  // SRC_INTERNAL_MINANGLE_REMESHING_VISIT_TABLE_H_
@@ -0,0 +1,81 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// SampleStrategy::k_error_driven on a regular tetrahedron (congruent faces
+// with the same feature intensities): before the errors are measured all the
+// faces get the unscaled number of samples; once measured, a face near the
+// max error threshold gets more samples than that, and a face far below the
+// threshold fewer.
+
+// C/C++
+#include <iostream>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/boost/graph/helpers.h>
+// local
+#include "internal/minangle_remeshing/minangle_remesh_impl.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef CGAL::Polygon_mesh_processing::internal::Minangle_remesher<Kernel>
+    Minangle_remesher;
+typedef Minangle_remesher::Mesh_properties_ Mesh_properties;
+typedef Minangle_remesher::Mesh Mesh;
+typedef Minangle_remesher::Point Point;
+typedef Minangle_remesher::FT FT;
+typedef Minangle_remesher::face_descriptor face_descriptor;
+
+int main() {
+  // 1) a regular tetrahedron, the remesh is a copy of the input
+  Mesh input, remesh;
+  CGAL::make_tetrahedron(Point(1.0, 1.0, 1.0), Point(1.0, -1.0, -1.0),
+    Point(-1.0, 1.0, -1.0), Point(-1.0, -1.0, 1.0), input);
+  remesh = input;
+  Minangle_remesher remesher;
+  remesher.set_sample_strategy(SampleStrategy::k_error_driven);
+  remesher.set_samples_per_face_out(40);
+  remesher.set_input(&input, false);
+  remesher.set_remesh(&remesh, false);
+  // 2) first pass, no error has been measured yet
+  remesher.generate_samples_and_links();
+  Mesh_properties *mesh_properties = remesher.get_remesh();
+  const Mesh &mesh = mesh_properties->get_mesh();
+  face_descriptor near_fd = *mesh.faces().begin();
+  face_descriptor far_fd = *(++mesh.faces().begin());
+  std::size_t nb_unmeasured =
+    mesh_properties->get_face_out_links(near_fd).size();
+  if (mesh_properties->get_face_out_links(far_fd).size() != nb_unmeasured) {
+    std::cerr << "the unmeasured faces got different numbers of samples"
+      << std::endl;
+    return 1;
+  }
+  // 3) second pass, one face near the threshold and one far below it
+  FT threshold = mesh_properties->get_max_squared_error_threshold();
+  mesh_properties->set_face_max_squared_error(near_fd, 0.9 * threshold);
+  mesh_properties->set_face_max_squared_error(far_fd, 1e-4 * threshold);
+  remesher.calculate_feature_intensities(false, true, false);
+  remesher.generate_samples_and_links();
+  std::size_t nb_near = mesh_properties->get_face_out_links(near_fd).size();
+  std::size_t nb_far = mesh_properties->get_face_out_links(far_fd).size();
+  std::cout << "samples per face: " << nb_unmeasured << " (unmeasured), "
+    << nb_near << " (near the threshold), " << nb_far << " (far below)"
+    << std::endl;
+  return nb_near > nb_unmeasured && nb_unmeasured > nb_far ? 0 : 1;
+}
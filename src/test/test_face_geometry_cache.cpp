@@ -0,0 +1,92 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// After a min angle remeshing with the face geometry cache (optimization and
+// relocation after the local operations included), the cached areas, longest
+// halfedges and minimal radian must be the ones computed without the cache.
+// usage: test_face_geometry_cache <data directory>
+
+// C/C++
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+// local
+#include "internal/minangle_remeshing/minangle_remesh_impl.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef CGAL::Polygon_mesh_processing::internal::Minangle_remesher<Kernel>
+    Minangle_remesher;
+typedef Minangle_remesher::Mesh_properties_ Mesh_properties;
+typedef Minangle_remesher::Mesh Mesh;
+typedef Minangle_remesher::FT FT;
+typedef Minangle_remesher::halfedge_descriptor halfedge_descriptor;
+
+int main(int argc, char *argv[]) {
+  // 1) remesh a bundled model with the cache
+  std::string file_name = std::string(argc > 1 ? argv[1] : "data") +
+    "/u.off";
+  std::ifstream in(file_name.c_str());
+  Mesh input, remesh;
+  if (!(in >> input) || input.is_empty()) {
+    std::cerr << "cannot read " << file_name << std::endl;
+    return 1;
+  }
+  remesh = input;
+  Minangle_remesher remesher;
+  remesher.set_use_face_geometry_cache(true);
+  remesher.set_relocate_after_local_operations(true);
+  remesher.set_optimize_after_local_operations(true);
+  remesher.set_input(&input, false);
+  remesher.set_remesh(&remesh, false);
+  remesher.minangle_remeshing();
+  // 2) the cached values
+  Mesh_properties *mesh_properties = remesher.get_remesh();
+  const Mesh &mesh = mesh_properties->get_mesh();
+  std::vector<FT> areas;
+  std::vector<halfedge_descriptor> longest_halfedges;
+  for (auto fi = mesh.faces().begin(); fi != mesh.faces().end(); ++fi) {
+    areas.push_back(mesh_properties->area(*fi));
+    longest_halfedges.push_back(mesh_properties->get_longest_halfedge(*fi));
+  }
+  FT cached_radian = 0.0;
+  mesh_properties->calculate_minimal_radian(&cached_radian);
+  // 3) the values computed from the points
+  mesh_properties->set_use_face_geometry_cache(false);
+  int nb_stale_faces = 0;
+  std::size_t i = 0;
+  for (auto fi = mesh.faces().begin(); fi != mesh.faces().end(); ++fi, ++i) {
+    if (std::abs(areas[i] - mesh_properties->area(*fi)) > 1e-12 ||
+        longest_halfedges[i] != mesh_properties->get_longest_halfedge(*fi)) {
+      ++nb_stale_faces;
+    }
+  }
+  FT radian = 0.0;
+  mesh_properties->calculate_minimal_radian(&radian);
+  std::cout << "faces: " << mesh.number_of_faces() << ", stale faces: "
+    << nb_stale_faces << ", minimal radian: " << cached_radian
+    << " (cached), " << radian << " (computed)" << std::endl;
+  return nb_stale_faces == 0 && std::abs(cached_radian - radian) < 1e-12 ?
+    0 : 1;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2019 INRIA Sophia-Antipolis (France).
+// All rights reserved.
+//
+// This file is part of CGAL (www.cgal.org).
+// You can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// Licensees holding a valid commercial license may use this file in
+// accordance with the commercial license agreement provided with the software.
+//
+// This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+// WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// $URL$
+// $Id$
+// SPDX-License-Identifier: GPL-3.0+
+//
+//
+// Author(s)     : Kaimo Hu
+
+// Two remeshers alive at once, on inputs far from each other: the links of
+// the first one must still decode to its own vertices after the second one
+// has set its input (with -DCGAL_MINANGLE_COMPACT_LINKS the end points are
+// stored relative to the origin of their mesh).
+
+// C/C++
+#include <iostream>
+// CGAL
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/boost/graph/helpers.h>
+// local
+#include "internal/minangle_remeshing/minangle_remesh_impl.h"
+
+typedef CGAL::Simple_cartesian<double> Kernel;
+typedef CGAL::Polygon_mesh_processing::internal::Minangle_remesher<Kernel>
+    Minangle_remesher;
+typedef Minangle_remesher::Mesh_properties_ Mesh_properties;
+typedef Minangle_remesher::Mesh Mesh;
+typedef Minangle_remesher::Point Point;
+typedef Minangle_remesher::Vector Vector;
+typedef Minangle_remesher::FT FT;
+
+void make_tetrahedron(const Vector &offset, Mesh *mesh) {
+  CGAL::make_tetrahedron(Point(0.0, 0.0, 0.0) + offset,
+    Point(1.0, 0.0, 0.0) + offset, Point(0.0, 1.0, 0.0) + offset,
+    Point(0.0, 0.0, 1.0) + offset, *mesh);
+}
+
+// largest distance between the vertices and the start of their out links
+FT max_vertex_link_error(const Mesh_properties &mesh_properties) {
+  const Mesh &mesh = mesh_properties.get_mesh();
+  FT max_squared_error = 0.0;
+  for (auto vi = mesh.vertices().begin(); vi != mesh.vertices().end(); ++vi) {
+    const Point &start = mesh_properties.to_point(
+      mesh_properties.get_vertex_out_link(*vi).second.first);
+    max_squared_error = CGAL::max(max_squared_error,
+      CGAL::squared_distance(start, mesh_properties.get_point(*vi)));
+  }
+  return CGAL::sqrt(max_squared_error);
+}
+
+int main() {
+  // 1) a remesher around the origin
+  Mesh near_input, near_remesh;
+  make_tetrahedron(Vector(0.0, 0.0, 0.0), &near_input);
+  near_remesh = near_input;
+  Minangle_remesher near_remesher;
+  near_remesher.set_input(&near_input, false);
+  near_remesher.set_remesh(&near_remesh, false);
+  near_remesher.generate_samples_and_links();
+  // 2) another one far away, set up while the first one keeps its links
+  Mesh far_input, far_remesh;
+  make_tetrahedron(Vector(1e4, -1e4, 1e4), &far_input);
+  far_remesh = far_input;
+  Minangle_remesher far_remesher;
+  far_remesher.set_input(&far_input, false);
+  far_remesher.set_remesh(&far_remesh, false);
+  far_remesher.generate_samples_and_links();
+  // 3) both must decode their own links
+  FT near_error = max_vertex_link_error(*near_remesher.get_remesh());
+  FT far_error = max_vertex_link_error(*far_remesher.get_remesh());
+  std::cout << "max vertex link error: " << near_error << " (near), "
+    << far_error << " (far)" << std::endl;
+  return near_error < 1e-5 && far_error < 1e-5 ? 0 : 1;
+}